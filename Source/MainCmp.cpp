@@ -10,12 +10,12 @@
 
 #include <JuceHeader.h>
 #include "MainCmp.h"
-
-#include <windows.h> // For Windows API (console manipulation)
+#include "debug/Trace.h"
 
 
 //==============================================================================
-MainCmp::MainCmp()
+MainCmp::MainCmp(Juce_sandboxAudioProcessor& p)
+    : audioProcessor(p)
 {
     addAndMakeVisible(redButton);
     addAndMakeVisible(graph);
@@ -23,19 +23,114 @@ MainCmp::MainCmp()
     redButton.addListener(this); // Add listener
     // NOTE: Don't use setSize() for child components, their size is always managed by parents in their resized() fct
 
+    // Start from whatever curve the processor is running, and push every edit back to it
+    const auto curve = audioProcessor.getCurve();
+    graph.setDots(curve.toDots(), curve.toDynamics());
+    graph.onCurveChanged = [this]
+    {
+        audioProcessor.setCurve(CurveSnapshot::fromDots(graph.getDots(), graph.getDynamics()));
+    };
 
-    if (AllocConsole()) // Open a console window
+    // The breakpoint bands are parameters: the graph edits them as a host would
+    graph.onBandChanged = [this](int band, const BreakpointSettings& settings)
     {
-        freopen("CONOUT$", "w", stdout); // Redirect stdout to the console
-        freopen("CONOUT$", "w", stderr); // Redirect stderr to the console
-    }
+        audioProcessor.getBreakpoints().setSettings(band, settings);
+    };
+    graph.onBandGesture = [this](int band, bool starting)
+    {
+        if (starting)
+            audioProcessor.getBreakpoints().beginChangeGesture(band);
+        else
+            audioProcessor.getBreakpoints().endChangeGesture(band);
+    };
+
+    // Overlay the response of whatever the design thread last produced
+    audioProcessor.updateDisplayDesign();
+    showResponse();
+    // The analyzers only run while there's an editor to show them
+    audioProcessor.getPreAnalyzer().setEnabled(true);
+    audioProcessor.getPostAnalyzer().setEnabled(true);
+
+    startTimerHz(60);
+
+    /* Linear-phase mode and its filter length (item IDs are the tap counts) */
+    addAndMakeVisible(linearPhaseButton);
+    addAndMakeVisible(firLengthBox);
+
+    for (int taps = 4096; taps <= FirDesigner::MAX_LENGTH; taps *= 2)
+        firLengthBox.addItem(juce::String(taps) + " taps", taps);
+
+    linearPhaseButton.onClick = [this]
+    {
+        audioProcessor.setLinearPhase(linearPhaseButton.getToggleState());
+        firLengthBox.setEnabled(linearPhaseButton.getToggleState());
+    };
+    firLengthBox.onChange = [this]
+    {
+        audioProcessor.setFirLength(firLengthBox.getSelectedId());
+    };
+
+    /* Fit the cascade to the curve with as few sections as will do */
+    addAndMakeVisible(autoFitButton);
+    autoFitButton.onClick = [this] { audioProcessor.setAutoFit(autoFitButton.getToggleState()); };
+
+    /* Oversampling around the cascade (item IDs are the factors) */
+    addAndMakeVisible(oversamplingBox);
+    oversamplingBox.addItem("No oversampling", 1);
+    for (int factor = 2; factor <= Oversampler::MAX_FACTOR; factor *= 2)
+        oversamplingBox.addItem(juce::String(factor) + "x oversampling", factor);
+
+    oversamplingBox.onChange = [this] { audioProcessor.setOversampling(oversamplingBox.getSelectedId()); };
+
+    /* Measured response import, optionally inverted to get the correction curve */
+    addAndMakeVisible(importButton);
+    addAndMakeVisible(invertImportButton);
+    importButton.onClick = [this] { importMeasurement(); };
+
+    /* Presets, as used by the offline renderer too */
+    addAndMakeVisible(loadPresetButton);
+    addAndMakeVisible(savePresetButton);
+    loadPresetButton.onClick = [this] { loadPreset(); };
+    savePresetButton.onClick = [this] { savePreset(); };
+
+    /* Curve slots to compare, which hosts see as programs (item IDs are the slots plus one) */
+    addAndMakeVisible(slotBox);
+    for (int slot = 0; slot < audioProcessor.getNumPrograms(); ++slot)
+        slotBox.addItem("Slot " + audioProcessor.getProgramName(slot), slot + 1);
+
+    slotBox.onChange = [this]
+    {
+        audioProcessor.setCurrentProgram(slotBox.getSelectedId() - 1);
+        showSlot();
+    };
+    showSlot();
+
+    /* MIDI morph from the drawn curve to a stored one: pick what drives it, then draw the
+       other end and store it */
+    addAndMakeVisible(morphSourceBox);
+    addAndMakeVisible(morphTargetButton);
+    morphSourceBox.addItem("No morph", 1);
+    morphSourceBox.addItem("Morph by mod wheel", 2);
+    morphSourceBox.addItem("Morph by expression", 3);
+    morphSourceBox.addItem("Morph by note", 4);
+    morphSourceBox.onChange = [this] { setMorphSource(morphSourceBox.getSelectedId()); };
+    morphTargetButton.onClick = [this]
+    {
+        audioProcessor.setMorphTarget(CurveSnapshot::fromDots(graph.getDots()));
+    };
+
+    /* How much of real time processBlock takes, and any bad samples it has seen */
+    addAndMakeVisible(cpuMeter);
+
+    showSettings();
 }
 
 MainCmp::~MainCmp()
 {
     redButton.removeListener(this);
 
-    FreeConsole(); // Close the console when the application quits
+    audioProcessor.getPreAnalyzer().setEnabled(false);
+    audioProcessor.getPostAnalyzer().setEnabled(false);
 }
 
 void MainCmp::paint (juce::Graphics& g)
@@ -68,6 +163,24 @@ void MainCmp::resized()
     auto graph_rectangle = bounds.removeFromTop(bounds.getHeight() / 2);
     graph.setBounds(graph_rectangle); // passes X,Y,W,H
 
+    /* Processing mode controls in a strip just under the graph */
+    auto mode_rect = bounds.removeFromTop(30).reduced(5, 3);
+    linearPhaseButton.setBounds(mode_rect.removeFromLeft(120));
+    firLengthBox.setBounds(mode_rect.removeFromLeft(140));
+    autoFitButton.setBounds(mode_rect.removeFromLeft(90).withTrimmedLeft(10));
+    oversamplingBox.setBounds(mode_rect.removeFromLeft(150).withTrimmedLeft(10));
+    invertImportButton.setBounds(mode_rect.removeFromRight(80));
+    importButton.setBounds(mode_rect.removeFromRight(90));
+
+    /* Presets in a second strip */
+    auto preset_rect = bounds.removeFromTop(30).reduced(5, 3);
+    loadPresetButton.setBounds(preset_rect.removeFromLeft(110));
+    savePresetButton.setBounds(preset_rect.removeFromLeft(120).withTrimmedLeft(10));
+    slotBox.setBounds(preset_rect.removeFromLeft(100).withTrimmedLeft(10));
+    morphSourceBox.setBounds(preset_rect.removeFromLeft(180).withTrimmedLeft(10));
+    morphTargetButton.setBounds(preset_rect.removeFromLeft(130).withTrimmedLeft(10));
+    cpuMeter.setBounds(preset_rect.removeFromRight(300));
+
     /* Dummy button placed at center of bottom half */
     int redButt_w = bounds.getWidth() * 0.2f;
     int redButt_h = bounds.getHeight() * 0.1f;
@@ -76,11 +189,170 @@ void MainCmp::resized()
 
 }
 
+void MainCmp::timerCallback()
+{
+    bool breakpointsChanged = false;
+    for (int band = 0; band < BreakpointBands::NUM_BANDS; ++band)
+        breakpointsChanged = breakpointsChanged || audioProcessor.getBreakpoints().getSettings(band) != shownBreakpoints[(size_t)band];
+
+    if (audioProcessor.updateDisplayDesign() || breakpointsChanged)
+        showResponse();
+
+    if (audioProcessor.getStateVersion() != shownStateVersion || audioProcessor.getCurrentProgram() != shownSlot)
+    {
+        showSlot();
+        showSettings();
+    }
+
+    const auto sampleRate = audioProcessor.getSampleRate();
+    const bool preChanged = audioProcessor.getPreAnalyzer().process(sampleRate);
+    const bool postChanged = audioProcessor.getPostAnalyzer().process(sampleRate);
+
+    if (preChanged || postChanged)
+        graph.setSpectra(audioProcessor.getPreAnalyzer(), audioProcessor.getPostAnalyzer(), sampleRate);
+}
+
+void MainCmp::showResponse()
+{
+    const auto& design = audioProcessor.getDisplayDesign();
+    for (int band = 0; band < BreakpointBands::NUM_BANDS; ++band)
+        shownBreakpoints[(size_t)band] = audioProcessor.getBreakpoints().getSettings(band);
+    graph.setBands(shownBreakpoints);
+
+    if (design.sample_rate <= 0.0)
+        return;
+
+    // All of them, switched off or not, as the audio runs them; the graph keeps each band's
+    // row by its coefficients, so only the ones that moved are evaluated again. Designed at the cascade's rate, which with
+    // oversampling on is a close match below the host's Nyquist.
+    CoefficientBank breakpoints;
+    BreakpointBands::design(shownBreakpoints, design.sample_rate, breakpoints);
+
+    auto bank = design.bank;
+    for (int band = 0; band < breakpoints.num_sections && bank.num_sections < CoefficientBank::MAX_SECTIONS; ++band)
+        bank.setSection(bank.num_sections++, breakpoints.getSection(band));
+
+    graph.setResponse(bank, design.sample_rate);
+}
+
+void MainCmp::importMeasurement()
+{
+    importChooser = std::make_unique<juce::FileChooser>("Import a measured response", juce::File(), "*.txt;*.csv;*.frd");
+
+    importChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                               [this](const juce::FileChooser& chooser)
+    {
+        const auto file = chooser.getResult();
+        if (file == juce::File())
+            return;
+
+        MeasurementImporter::Options options;
+        options.invert = invertImportButton.getToggleState();
+
+        std::vector<std::pair<float, float>> dots;
+        const auto result = importer.importFile(file, options, dots);
+        if (result.failed())
+        {
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Import failed", result.getErrorMessage());
+            return;
+        }
+
+        DRAW_TRACE("imported %d rows as %d dots (%.2f dB)", importer.getNumRows(), (int)dots.size(), importer.getMaxErrorDb());
+        graph.setDots(dots);
+        audioProcessor.setCurve(CurveSnapshot::fromDots(dots));
+    });
+}
+
+void MainCmp::loadPreset()
+{
+    presetChooser = std::make_unique<juce::FileChooser>("Load a preset", juce::File(), "*.xml");
+
+    presetChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                               [this](const juce::FileChooser& chooser)
+    {
+        const auto file = chooser.getResult();
+        if (file == juce::File())
+            return;
+
+        CurvePreset preset;
+        const auto result = preset.loadFrom(file);
+        if (result.failed())
+        {
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Loading the preset failed", result.getErrorMessage());
+            return;
+        }
+
+        audioProcessor.setPreset(preset);
+        showSlot();
+        showSettings();
+    });
+}
+
+void MainCmp::savePreset()
+{
+    presetChooser = std::make_unique<juce::FileChooser>("Save the preset", juce::File(), "*.xml");
+
+    presetChooser->launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles
+                                   | juce::FileBrowserComponent::warnAboutOverwriting,
+                               [this](const juce::FileChooser& chooser)
+    {
+        const auto file = chooser.getResult();
+        if (file == juce::File())
+            return;
+
+        const auto result = audioProcessor.getPreset().saveTo(file.withFileExtension("xml"));
+        if (result.failed())
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Saving the preset failed", result.getErrorMessage());
+    });
+}
+
+void MainCmp::showSettings()
+{
+    shownStateVersion = audioProcessor.getStateVersion();
+    linearPhaseButton.setToggleState(audioProcessor.isLinearPhase(), juce::dontSendNotification);
+    firLengthBox.setSelectedId(audioProcessor.getFirLength(), juce::dontSendNotification);
+    firLengthBox.setEnabled(audioProcessor.isLinearPhase());
+    autoFitButton.setToggleState(audioProcessor.isAutoFit(), juce::dontSendNotification);
+    oversamplingBox.setSelectedId(audioProcessor.getOversampling(), juce::dontSendNotification);
+    morphSourceBox.setSelectedId(getMorphSourceItem(), juce::dontSendNotification);
+}
+
+void MainCmp::showSlot()
+{
+    shownSlot = audioProcessor.getCurrentProgram();
+    slotBox.setSelectedId(shownSlot + 1, juce::dontSendNotification);
+
+    const auto curve = audioProcessor.getCurve();
+    graph.setDots(curve.toDots(), curve.toDynamics());
+}
+
+void MainCmp::setMorphSource(int itemId)
+{
+    auto settings = audioProcessor.getMorphSettings();
+    settings.source = itemId == 4 ? MorphSettings::Source::Notes
+                    : itemId >= 2 ? MorphSettings::Source::Controller
+                                  : MorphSettings::Source::Off;
+    settings.controller = itemId == 3 ? 11 : 1;
+    audioProcessor.setMorphSettings(settings);
+}
+
+int MainCmp::getMorphSourceItem() const
+{
+    const auto settings = audioProcessor.getMorphSettings();
+    switch (settings.source)
+    {
+        case MorphSettings::Source::Notes:      return 4;
+        case MorphSettings::Source::Controller: return settings.controller == 11 ? 3 : 2;
+        case MorphSettings::Source::Off:
+        default:                                return 1;
+    }
+}
+
 // Button::Listener overrides
 void MainCmp::buttonClicked(juce::Button* button)
 {
     if (button == &redButton)
     {
-        std::cout << "red butt" << std::endl;
+        DRAW_TRACE("red butt");
     }
 }
@@ -14,14 +14,17 @@
 // user
 #include "buttons/RedButt.h"
 #include "graph/graphCmp.h"
+#include "meters/CpuMeter.h"
+#include "dsp/MeasurementImporter.h"
+#include "PluginProcessor.h"
 
 //==============================================================================
 /*
 */
-class MainCmp  : public juce::Component, juce::Button::Listener
+class MainCmp  : public juce::Component, juce::Button::Listener, private juce::Timer
 {
 public:
-    MainCmp();
+    MainCmp(Juce_sandboxAudioProcessor& p);
     ~MainCmp() override;
 
     void paint (juce::Graphics&) override;
@@ -31,10 +34,51 @@ public:
     void buttonClicked(juce::Button* button) override;
 
 private:
+    // Polls the processor for designs, breakpoint parameters, slot switches and spectra to draw
+    void timerCallback() override;
+
+    // Draws the latest design with the breakpoints' sections after it, as the audio runs them
+    void showResponse();
+
+    // Replaces the curve with a measurement file picked by the user
+    void importMeasurement();
+
+    // Preset files hold the curve and every processing setting
+    void loadPreset();
+    void savePreset();
+    void showSettings(); // After the processor's changed under the controls
+    void showSlot();     // The current slot's curve, in the graph and the slot box
+
+    // The morph source box's items: off, mod wheel, expression pedal, or keytracked notes
+    void setMorphSource(int itemId);
+    int getMorphSourceItem() const;
+
+    Juce_sandboxAudioProcessor& audioProcessor;
 
     // Child components
     RedButt redButton;
     FrequencyGraph graph;
+    juce::ToggleButton linearPhaseButton{ "Linear phase" };
+    juce::ComboBox firLengthBox;
+    juce::ToggleButton autoFitButton{ "Auto-fit" };
+    juce::ComboBox oversamplingBox;
+    juce::TextButton importButton{ "Import..." };
+    juce::ToggleButton invertImportButton{ "Invert" };
+    juce::TextButton loadPresetButton{ "Load preset..." };
+    juce::TextButton savePresetButton{ "Save preset..." };
+    juce::ComboBox slotBox;
+    juce::ComboBox morphSourceBox;
+    juce::TextButton morphTargetButton{ "Set morph target" };
+    CpuMeter cpuMeter{ audioProcessor.getPerformanceCounters() };
+
+    // Breakpoints as last drawn; hosts and generic editors change them behind our back
+    std::array<BreakpointSettings, BreakpointBands::NUM_BANDS> shownBreakpoints;
+    // Slot and processor state as last shown; hosts switch programs and restore state behind our back too
+    int shownSlot = 0;
+    juce::uint32 shownStateVersion = 0;
+
+    std::unique_ptr<juce::FileChooser> importChooser, presetChooser;
+    MeasurementImporter importer;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainCmp)
 };
@@ -14,7 +14,7 @@
 
 //==============================================================================
 Juce_sandboxAudioProcessorEditor::Juce_sandboxAudioProcessorEditor (Juce_sandboxAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), audioProcessor (p), main_cmp (p)
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
@@ -22,6 +22,9 @@ Juce_sandboxAudioProcessor::Juce_sandboxAudioProcessor()
                        )
 #endif
 {
+    _curve = getFlatCurve();
+    _slots.fill (_curve);
+    _breakpoints.attach (_parameters);
 }
 
 Juce_sandboxAudioProcessor::~Juce_sandboxAudioProcessor()
@@ -63,44 +66,126 @@ bool Juce_sandboxAudioProcessor::isMidiEffect() const
 
 double Juce_sandboxAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // The FIR rings for its whole length; the cascade's tail is short enough to ignore
+    return isLinearPhase() ? getFirLength() / getDesignSampleRate() : 0.0;
 }
 
 int Juce_sandboxAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    return SlotDesigns::NUM_SLOTS;
 }
 
 int Juce_sandboxAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return _current_slot.load();
 }
 
 void Juce_sandboxAudioProcessor::setCurrentProgram (int index)
 {
+    if (! juce::isPositiveAndBelow (index, SlotDesigns::NUM_SLOTS))
+        return;
+
+    // Hosts may change programs from any thread. Off the message thread, leave the switch to
+    // handleAsyncUpdate(), as setStateInformation() does.
+    if (juce::MessageManager::existsAndIsCurrentThread())
+    {
+        switchSlot (index);
+    }
+    else
+    {
+        _requested_slot = index;
+        triggerAsyncUpdate();
+    }
 }
 
 const juce::String Juce_sandboxAudioProcessor::getProgramName (int index)
 {
-    return {};
+    if (! juce::isPositiveAndBelow (index, SlotDesigns::NUM_SLOTS))
+        return {};
+
+    return juce::String::charToString ((juce::juce_wchar) ('A' + index));
 }
 
 void Juce_sandboxAudioProcessor::changeProgramName (int index, const juce::String& newName)
 {
+    // Slots go by their letters
+    juce::ignoreUnused (index, newName);
 }
 
 //==============================================================================
 void Juce_sandboxAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    // Use this method as the place to do any pre-playback
-    // initialisation that you need..
+    const int factor = getOversampling();
+    _oversampler.prepare (getTotalNumOutputChannels(), samplesPerBlock, factor);
+    _eq.prepare (sampleRate * factor, samplesPerBlock * factor, getTotalNumOutputChannels());
+
+    // The audio thread isn't running yet, so the design can go straight in.
+    // Anything still queued for the old sample rate gets ignored by processBlock.
+    const auto curve = getCurve();
+    const auto morphTarget = getMorphSettings().source != MorphSettings::Source::Off ? getMorphTarget() : CurveSnapshot();
+    const int slot = getCurrentProgram();
+    const juce::ScopedLock lock (_design_lock);
+
+    auto& display = _display_designs.getWriteBuffer();
+    display.curve = curve;
+    display.sample_rate = sampleRate * factor;
+    display.slot = slot;
+    designBank (curve, sampleRate * factor, isAutoFit(), getFitTolerance(), display.bank);
+
+    CurveMorph::design (curve, morphTarget, sampleRate * factor, _morph_tables.getWriteBuffer());
+    _morph_tables.publish();
+    _morph_tables.update();
+    _running_slot = _morph_slot = slot;
+
+    if (isMorphing())
+    {
+        CurveMorph::interpolate (_morph_tables.getReadBuffer(), _morph_position, _morph_bank);
+        _eq.setCoefficients (_morph_bank, false);
+    }
+    else
+    {
+        _eq.setCoefficients (display.bank, false);
+    }
+
+    _breakpoints.prepare (sampleRate, getTotalNumOutputChannels());
+
+    DynamicBands::design (curve, sampleRate, display.dynamics);
+    _dynamics.prepare (sampleRate, getTotalNumOutputChannels());
+    _dynamics.setDesign (display.dynamics);
+    _display_designs.publish();
+
+    // Every other slot's designs too, so processBlock can switch from its first block
+    updateSlotDesigns (slot, sampleRate, factor);
+    _slot_design_cache.banks[(size_t) slot] = display.bank;
+    _slot_design_cache.dynamics[(size_t) slot] = display.dynamics;
+    _slot_design_cache.versions[(size_t) slot] = _slot_versions[(size_t) slot].load();
+    _slot_designs.getWriteBuffer() = _slot_design_cache;
+    _slot_designs.publish();
+    _slot_designs.update();
+
+    // The FIR kernel and its tail worker only while linear phase is on; designAndPublish()
+    // brings them in when it's switched on later
+    _convolver.prepare (getTotalNumOutputChannels());
+    if (isLinearPhase())
+    {
+        publishKernel (curve, sampleRate, getFirLength());
+        _convolver.start();
+    }
+
+    _run_linear_phase = _linear_phase.load();
+    _was_linear_phase = _run_linear_phase.load();
+
+    _max_design_latency_ms = 0.0f;
+    _counters.prepare (sampleRate);
+
+    updateLatency();
 }
 
 void Juce_sandboxAudioProcessor::releaseResources()
 {
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
+    // Nothing for the FIR tail worker to do until we're prepared again
+    const juce::ScopedLock lock (_design_lock);
+    _convolver.release();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -110,12 +195,9 @@ bool Juce_sandboxAudioProcessor::isBusesLayoutSupported (const BusesLayout& layo
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any number of channels in any layout, discrete, surround or ambisonic: every
+    // channel gets the same EQ, and wide buses run their channels across vector lanes
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -132,6 +214,8 @@ bool Juce_sandboxAudioProcessor::isBusesLayoutSupported (const BusesLayout& layo
 void Juce_sandboxAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    _counters.beginBlock (buffer);
+
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -144,18 +228,533 @@ void Juce_sandboxAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    // This is the place where you'd normally do the guts of your plugin's
-    // audio processing...
-    // Make sure to reset the state if your inner loop is processing
-    // the samples and the outer loop is handling the channels.
-    // Alternatively, you can process the samples with the channels
-    // interleaved by keeping the same state.
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
+    // A slot switch needs no design: the design thread keeps every slot's ready, so this is a
+    // copy of one bank and the engine's usual glide, whatever the curves hold. A slot whose
+    // curve has changed since (a preset's, say) waits for the design thread to catch up.
+    _slot_designs.update();
+    const int slot = _current_slot.load();
+    if (slot != _running_slot)
+    {
+        const auto& slots = _slot_designs.getReadBuffer();
+        if (slots.sample_rate == _eq.getSampleRate() && slots.versions[(size_t) slot] == _slot_versions[(size_t) slot].load())
+        {
+            _eq.setCoefficients (slots.banks[(size_t) slot]);
+            _dynamics.setDesign (slots.dynamics[(size_t) slot]);
+            _running_slot = slot;
+        }
+    }
+
+    // Pick up the latest design if the design thread published one (wait-free, no copy of the
+    // curve). One made for a slot since switched away from has nothing to add.
+    if (_designs.update())
     {
-        auto* channelData = buffer.getWritePointer (channel);
+        const auto& design = _designs.getReadBuffer();
+        if (design.sample_rate == _eq.getSampleRate() && design.slot == _running_slot)
+        {
+            // With a morph, the cascade comes from the table published along with the design
+            _morph_tables.update();
+            _morph_slot = design.slot;
+            if (isMorphing())
+            {
+                CurveMorph::interpolate (_morph_tables.getReadBuffer(), _morph_position, _morph_bank);
+                _eq.setCoefficients (_morph_bank);
+            }
+            else
+            {
+                _eq.setCoefficients (design.bank);
+            }
 
-        // ..do something to the data...
+            _dynamics.setDesign (design.dynamics);
+
+            const auto latencyMs = (float) (juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks()
+                                                                                      - design.submitted_ticks) * 1000.0);
+            _design_latency_ms.store (latencyMs, std::memory_order_relaxed);
+            if (latencyMs > _max_design_latency_ms.load (std::memory_order_relaxed))
+                _max_design_latency_ms.store (latencyMs, std::memory_order_relaxed);
+        }
     }
+
+    const bool linearPhase = _run_linear_phase.load();
+    if (linearPhase != _was_linear_phase)
+    {
+        // Don't let the path we're switching to resume from stale state
+        if (linearPhase)
+        {
+            _convolver.reset();
+        }
+        else
+        {
+            _eq.reset();
+            _oversampler.reset();
+        }
+
+        _was_linear_phase = linearPhase;
+    }
+
+    _pre_analyzer.push (buffer);
+
+    if (linearPhase)
+        _convolver.process (buffer);
+    else
+        processCascade (buffer, midiMessages);
+
+    _breakpoints.process (buffer);
+    _dynamics.process (buffer);
+
+    // ScopedNoDenormals only helps if nothing else on this thread turns FTZ back off, and
+    // NaN in a recursive filter never leaves by itself, so check the state every block
+    auto repairs = _eq.sanitiseState();
+    repairs += _breakpoints.sanitiseState();
+    repairs += _dynamics.sanitiseState();
+    _counters.countRepairs (repairs);
+
+    _post_analyzer.push (buffer);
+    _counters.endBlock (buffer);
+}
+
+void Juce_sandboxAudioProcessor::processCascade (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    int start = 0;
+
+    // Split the block at each event that moves the morph, so the cascade starts gliding
+    // on the event's own sample. Events on the same sample leave nothing in between.
+    if (isMorphing())
+    {
+        const auto settings = getMorphSettings();
+
+        for (const auto metadata : midiMessages)
+        {
+            const float position = settings.getPosition (metadata.getMessage());
+            if (position < 0.0f)
+                continue;
+
+            const int at = juce::jlimit (start, buffer.getNumSamples(), metadata.samplePosition);
+            processCascadeRange (buffer, start, at - start);
+            start = at;
+
+            setMorphPosition (position);
+        }
+    }
+
+    processCascadeRange (buffer, start, buffer.getNumSamples() - start);
+}
+
+void Juce_sandboxAudioProcessor::processCascadeRange (juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    // In place, by offset: a buffer referring to the range would allocate its channel list for wide buses
+    if (_oversampler.getFactor() > 1)
+        processOversampled (buffer, startSample, numSamples);
+    else
+        _eq.process (buffer, startSample, numSamples);
+}
+
+void Juce_sandboxAudioProcessor::setMorphPosition (float position)
+{
+    // No redesign: two neighbouring steps of the table, mixed, then the engine's usual glide
+    if (position == _morph_position)
+        return;
+
+    _morph_position = position;
+    CurveMorph::interpolate (_morph_tables.getReadBuffer(), position, _morph_bank);
+    _eq.setCoefficients (_morph_bank);
+}
+
+bool Juce_sandboxAudioProcessor::isMorphing() const
+{
+    const auto& table = _morph_tables.getReadBuffer();
+    return table.num_sections > 0 && table.sample_rate == _eq.getSampleRate() && _morph_slot == _running_slot;
+}
+
+void Juce_sandboxAudioProcessor::processOversampled (juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    // Hosts may pass more than they said in prepareToPlay, so go in chunks the oversampler can take
+    const int maxBlock = _oversampler.getMaximumBlockSize();
+    for (int done = 0; done < numSamples; done += maxBlock)
+    {
+        const int chunk = juce::jmin (maxBlock, numSamples - done);
+
+        _eq.process (_oversampler.processUp (buffer, startSample + done, chunk));
+        _oversampler.processDown (buffer, startSample + done, chunk);
+    }
+}
+
+void Juce_sandboxAudioProcessor::setNonRealtime (bool isNonRealtime) noexcept
+{
+    AudioProcessor::setNonRealtime (isNonRealtime);
+    _convolver.setNonRealtime (isNonRealtime);
+}
+
+//==============================================================================
+juce::AudioProcessorValueTreeState::ParameterLayout Juce_sandboxAudioProcessor::createParameterLayout()
+{
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+    BreakpointBands::addParameters (layout);
+    return layout;
+}
+
+CurveSnapshot Juce_sandboxAudioProcessor::getFlatCurve()
+{
+    return CurveSnapshot::fromDots ({ { 10.0f, 0.0f }, { 20000.0f, 0.0f } });
+}
+
+double Juce_sandboxAudioProcessor::getDesignSampleRate() const
+{
+    auto sampleRate = getSampleRate();
+    return sampleRate > 0.0 ? sampleRate : 44100.0;
+}
+
+void Juce_sandboxAudioProcessor::setCurve (const CurveSnapshot& curve)
+{
+    {
+        const juce::ScopedLock lock (_curve_lock);
+        _curve = curve;
+        ++_slot_versions[(size_t) _current_slot.load()];
+    }
+
+    submitDesign();
+}
+
+CurveSnapshot Juce_sandboxAudioProcessor::getCurve() const
+{
+    const juce::ScopedLock lock (_curve_lock);
+    return _curve;
+}
+
+void Juce_sandboxAudioProcessor::setMorphTarget (const CurveSnapshot& target)
+{
+    {
+        const juce::ScopedLock lock (_curve_lock);
+        _morph_target = target;
+    }
+
+    if (getMorphSettings().source != MorphSettings::Source::Off)
+        submitDesign();
+}
+
+CurveSnapshot Juce_sandboxAudioProcessor::getMorphTarget() const
+{
+    const juce::ScopedLock lock (_curve_lock);
+    return _morph_target;
+}
+
+void Juce_sandboxAudioProcessor::setMorphSettings (const MorphSettings& settings)
+{
+    const bool wasOn = getMorphSettings().source != MorphSettings::Source::Off;
+
+    _morph_controller = juce::jlimit (0, 127, settings.controller);
+    _morph_low_note = juce::jlimit (0, 127, settings.low_note);
+    _morph_high_note = juce::jlimit (0, 127, settings.high_note);
+    _morph_source = (int) settings.source;
+
+    // Only switching the morph on or off changes what gets designed
+    if (wasOn != (settings.source != MorphSettings::Source::Off))
+        submitDesign();
+}
+
+MorphSettings Juce_sandboxAudioProcessor::getMorphSettings() const
+{
+    MorphSettings settings;
+    settings.source = (MorphSettings::Source) _morph_source.load();
+    settings.controller = _morph_controller.load();
+    settings.low_note = _morph_low_note.load();
+    settings.high_note = _morph_high_note.load();
+    return settings;
+}
+
+void Juce_sandboxAudioProcessor::setLinearPhase (bool shouldBeLinearPhase)
+{
+    if (shouldBeLinearPhase == isLinearPhase())
+        return;
+
+    _linear_phase = shouldBeLinearPhase;
+    submitDesign();
+    updateLatency();
+}
+
+void Juce_sandboxAudioProcessor::setFirLength (int numTaps)
+{
+    numTaps = FirDesigner::roundLength (numTaps);
+    if (numTaps == getFirLength())
+        return;
+
+    _fir_length = numTaps;
+
+    if (isLinearPhase())
+        submitDesign();
+
+    updateLatency();
+}
+
+void Juce_sandboxAudioProcessor::setAutoFit (bool shouldAutoFit)
+{
+    if (shouldAutoFit == isAutoFit())
+        return;
+
+    _auto_fit = shouldAutoFit;
+    submitDesign();
+}
+
+void Juce_sandboxAudioProcessor::setFitTolerance (float toleranceDb)
+{
+    toleranceDb = juce::jlimit (0.05f, 6.0f, toleranceDb);
+    if (toleranceDb == getFitTolerance())
+        return;
+
+    _fit_tolerance_db = toleranceDb;
+
+    if (isAutoFit())
+        submitDesign();
+}
+
+void Juce_sandboxAudioProcessor::setOversampling (int factor)
+{
+    factor = factor >= 8 ? 8 : factor >= 4 ? 4 : factor >= 2 ? 2 : 1;
+    if (factor == getOversampling())
+        return;
+
+    _oversampling = factor;
+
+    // The cascade and the filters around it are reallocated for the new rate. Suspending
+    // waits for a processBlock in progress and keeps the host from calling another meanwhile.
+    if (getSampleRate() > 0.0)
+    {
+        suspendProcessing (true);
+        prepareToPlay (getSampleRate(), getBlockSize());
+        suspendProcessing (false);
+    }
+    else
+    {
+        submitDesign();
+    }
+}
+
+CurvePreset Juce_sandboxAudioProcessor::getPreset() const
+{
+    CurvePreset preset;
+    getPreset (preset);
+    return preset;
+}
+
+void Juce_sandboxAudioProcessor::getPreset (CurvePreset& preset) const
+{
+    {
+        const juce::ScopedLock lock (_curve_lock);
+        preset.curve = _curve;
+        preset.slots = _slots;
+        preset.current_slot = _current_slot.load();
+        preset.slots[(size_t) preset.current_slot] = _curve;
+    }
+
+    preset.linear_phase = isLinearPhase();
+    preset.fir_length = getFirLength();
+    preset.auto_fit = isAutoFit();
+    preset.fit_tolerance_db = getFitTolerance();
+    preset.oversampling = getOversampling();
+    preset.morph_target = getMorphTarget();
+    preset.morph = getMorphSettings();
+
+    for (int band = 0; band < BreakpointBands::NUM_BANDS; ++band)
+        preset.breakpoints[(size_t) band] = _breakpoints.getSettings (band);
+}
+
+void Juce_sandboxAudioProcessor::setPreset (const CurvePreset& preset)
+{
+    // The curve goes in first, so a re-prepare for a new oversampling factor designs it
+    // rather than the old one. Each setter queues a design; the design thread coalesces
+    // them into the last one.
+    {
+        const juce::ScopedLock lock (_curve_lock);
+        _curve = preset.curve;
+        _morph_target = preset.morph_target;
+
+        _current_slot = juce::jlimit (0, SlotDesigns::NUM_SLOTS - 1, preset.current_slot);
+        for (int slot = 0; slot < SlotDesigns::NUM_SLOTS; ++slot)
+        {
+            const auto& slotCurve = preset.slots[(size_t) slot];
+            if (slot != _current_slot.load())
+                _slots[(size_t) slot] = slotCurve.num_points >= 2 ? slotCurve : getFlatCurve();
+
+            ++_slot_versions[(size_t) slot];
+        }
+    }
+
+    setMorphSettings (preset.morph);
+    setOversampling (preset.oversampling);
+    setFitTolerance (preset.fit_tolerance_db);
+    setAutoFit (preset.auto_fit);
+    setFirLength (preset.fir_length);
+    setLinearPhase (preset.linear_phase);
+    submitDesign();
+
+    // The breakpoints don't need a design: the audio thread glides to them itself
+    for (int band = 0; band < BreakpointBands::NUM_BANDS; ++band)
+        _breakpoints.setSettings (band, preset.breakpoints[(size_t) band]);
+
+    ++_state_version;
+}
+
+DesignMetrics Juce_sandboxAudioProcessor::getDesignMetrics() const
+{
+    DesignMetrics metrics;
+    metrics.designs_per_second = _design_worker.getDesignsPerSecond();
+    metrics.design_ms = _design_worker.getLastDesignMs();
+    metrics.latency_ms = _design_latency_ms.load (std::memory_order_relaxed);
+    metrics.max_latency_ms = _max_design_latency_ms.load (std::memory_order_relaxed);
+    metrics.num_submitted = _design_worker.getNumSubmitted();
+    metrics.num_designed = _design_worker.getNumDesigned();
+    metrics.idle = _design_worker.isIdle();
+    return metrics;
+}
+
+void Juce_sandboxAudioProcessor::submitDesign()
+{
+    DesignRequest request;
+    {
+        const juce::ScopedLock lock (_curve_lock);
+        request.curve = _curve;
+        request.slot = _current_slot.load();
+        request.slot_version = _slot_versions[(size_t) request.slot];
+    }
+
+    request.sample_rate = getDesignSampleRate();
+    request.oversampling = getOversampling();
+    request.fir_length = getFirLength();
+    request.linear_phase = isLinearPhase();
+    request.auto_fit = isAutoFit();
+    request.fit_tolerance_db = getFitTolerance();
+    if (getMorphSettings().source != MorphSettings::Source::Off)
+        request.morph_target = getMorphTarget();
+    _design_worker.submit (request);
+}
+
+void Juce_sandboxAudioProcessor::designAndPublish (const DesignRequest& request)
+{
+    // Design thread
+    const juce::ScopedLock lock (_design_lock);
+
+    // Made before a sample rate or oversampling change; prepareToPlay has already designed for the new rate
+    if (request.sample_rate != getDesignSampleRate() || request.oversampling != getOversampling())
+        return;
+
+    // Fill the writer's private slot in place, then swap it in. The cascade runs at the
+    // oversampled rate; the dynamic bands and the FIR kernel below at the host's.
+    const auto cascadeRate = request.sample_rate * request.oversampling;
+    auto& design = _designs.getWriteBuffer();
+    design.curve = request.curve;
+    design.sample_rate = cascadeRate;
+    design.submitted_ticks = request.submitted_ticks;
+    design.slot = request.slot;
+    designBank (request.curve, cascadeRate, request.auto_fit, request.fit_tolerance_db, design.bank);
+    DynamicBands::design (request.curve, request.sample_rate, design.dynamics);
+
+    // Ahead of the design, so processBlock has switched to its slot by the time it picks it up
+    updateSlotDesigns (request.slot, request.sample_rate, request.oversampling);
+    _slot_design_cache.banks[(size_t) request.slot] = design.bank;
+    _slot_design_cache.dynamics[(size_t) request.slot] = design.dynamics;
+    _slot_design_cache.versions[(size_t) request.slot] = request.slot_version;
+    _slot_designs.getWriteBuffer() = _slot_design_cache;
+    _slot_designs.publish();
+
+    // Ahead of the design, which processBlock picks it up with
+    CurveMorph::design (request.curve, request.morph_target, cascadeRate, _morph_tables.getWriteBuffer());
+    _morph_tables.publish();
+
+    _display_designs.getWriteBuffer() = design;
+    _display_designs.publish();
+    _designs.publish();
+
+    // Have a kernel for the current curve in flight before the audio thread switches over
+    if (request.linear_phase)
+    {
+        publishKernel (request.curve, request.sample_rate, request.fir_length);
+        _convolver.start();
+    }
+
+    _run_linear_phase = request.linear_phase;
+
+    // A block still running the convolver just misses its tail, or stops waiting for it offline
+    if (! request.linear_phase)
+        _convolver.stop();
+}
+
+void Juce_sandboxAudioProcessor::designBank (const CurveSnapshot& curve, double sampleRate, bool autoFit, float toleranceDb, CoefficientBank& bank)
+{
+    // Caller holds _design_lock
+    if (autoFit)
+    {
+        _curve_fitter.fit (curve, sampleRate, toleranceDb, bank);
+        return;
+    }
+
+    // Start the next auto-fit from scratch rather than from a curve long gone
+    _curve_fitter.reset();
+    CurveDesigner::design (curve, sampleRate, bank);
+}
+
+void Juce_sandboxAudioProcessor::publishKernel (const CurveSnapshot& curve, double sampleRate, int firLength)
+{
+    // Caller holds _design_lock
+    _fir_designer.design (curve, sampleRate, firLength,
+                          _convolver.getHeadKernelToWrite(), _convolver.getTailKernelToWrite());
+    _convolver.publishKernel();
+}
+
+void Juce_sandboxAudioProcessor::updateSlotDesigns (int except, double sampleRate, int oversampling)
+{
+    // Caller holds _design_lock. Only slots that changed since they were last designed, or all
+    // of them at a new rate. They're designed a section per dot even with auto-fit, which would
+    // throw away the fitter's last solution; switching to a slot queues its own design anyway.
+    const auto cascadeRate = sampleRate * oversampling;
+    const bool all = _slot_design_cache.sample_rate != cascadeRate;
+    _slot_design_cache.sample_rate = cascadeRate;
+
+    for (int slot = 0; slot < SlotDesigns::NUM_SLOTS; ++slot)
+    {
+        if (slot == except)
+            continue;
+
+        CurveSnapshot curve;
+        juce::uint32 version = 0;
+        {
+            const juce::ScopedLock lock (_curve_lock);
+            version = _slot_versions[(size_t) slot];
+            if (! all && version == _slot_design_cache.versions[(size_t) slot])
+                continue;
+
+            curve = slot == _current_slot.load() ? _curve : _slots[(size_t) slot];
+        }
+
+        CurveDesigner::design (curve, cascadeRate, _slot_design_cache.banks[(size_t) slot]);
+        DynamicBands::design (curve, sampleRate, _slot_design_cache.dynamics[(size_t) slot]);
+        _slot_design_cache.versions[(size_t) slot] = version;
+    }
+}
+
+void Juce_sandboxAudioProcessor::switchSlot (int index)
+{
+    {
+        const juce::ScopedLock lock (_curve_lock);
+        const int current = _current_slot.load();
+        if (index == current)
+            return;
+
+        _slots[(size_t) current] = _curve;
+        _curve = _slots[(size_t) index];
+        _current_slot = index;
+    }
+
+    // processBlock switches on its own; this brings everything else round to the new curve
+    submitDesign();
+    ++_state_version;
+}
+
+void Juce_sandboxAudioProcessor::updateLatency()
+{
+    setLatencySamples (isLinearPhase() ? NonUniformConvolver::getLatencySamples (getFirLength())
+                                       : _oversampler.getLatencySamples());
 }
 
 //==============================================================================
@@ -172,15 +771,52 @@ juce::AudioProcessorEditor* Juce_sandboxAudioProcessor::createEditor()
 //==============================================================================
 void Juce_sandboxAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    // The preset, with the counters in a chunk alongside so a saved session records how
+    // this instance ran
+    const juce::ScopedLock lock (_state_lock);
+    getPreset (*_state_preset);
+
+    juce::MemoryOutputStream out (destData, false);
+    _state_preset->writeBinary (out);
+    CurvePreset::writeChunkHeader (out, CurvePreset::chunkId ("PERF"), PerformanceCounters::Snapshot::BINARY_SIZE);
+    _counters.getSnapshot().writeBinary (out);
 }
 
 void Juce_sandboxAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    // The counters are this session's own, so any saved with the state are left out. A
+    // state that fails any check is ignored whole, leaving everything as it was.
+    const juce::ScopedLock lock (_state_lock);
+    if (_state_preset->readBinary (data, (size_t) juce::jmax (0, sizeInBytes)).failed())
+        return;
+
+    // Hosts may restore state from any thread. Off the message thread, stage it for
+    // handleAsyncUpdate() rather than take the message thread's side of the design handoff.
+    if (juce::MessageManager::existsAndIsCurrentThread())
+    {
+        _state_pending = false; // Anything staged before this is older
+        setPreset (*_state_preset);
+    }
+    else
+    {
+        std::swap (_state_preset, _staged_state);
+        _state_pending = true;
+        triggerAsyncUpdate();
+    }
+}
+
+void Juce_sandboxAudioProcessor::handleAsyncUpdate()
+{
+    {
+        const juce::ScopedLock lock (_state_lock);
+        if (_state_pending)
+            setPreset (*_staged_state);
+        _state_pending = false;
+    }
+
+    const int slot = _requested_slot.exchange (-1);
+    if (slot >= 0)
+        switchSlot (slot);
 }
 
 //==============================================================================
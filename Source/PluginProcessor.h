@@ -9,11 +9,26 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "dsp/BreakpointBands.h"
+#include "dsp/Curve.h"
+#include "dsp/CurveFitter.h"
+#include "dsp/CurveMorph.h"
+#include "dsp/CurvePreset.h"
+#include "dsp/DesignWorker.h"
+#include "dsp/DynamicBands.h"
+#include "dsp/EqEngine.h"
+#include "dsp/FirDesigner.h"
+#include "dsp/NonUniformConvolver.h"
+#include "dsp/Oversampler.h"
+#include "dsp/PerformanceCounters.h"
+#include "dsp/SpectrumAnalyzer.h"
+#include "dsp/TripleBuffer.h"
 
 //==============================================================================
 /**
 */
-class Juce_sandboxAudioProcessor  : public juce::AudioProcessor
+class Juce_sandboxAudioProcessor  : public juce::AudioProcessor,
+                                    private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -30,6 +45,9 @@ public:
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
+    // Offline renders wait for the FIR tail worker rather than drop its late blocks
+    void setNonRealtime (bool isNonRealtime) noexcept override;
+
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -43,6 +61,11 @@ public:
     double getTailLengthSeconds() const override;
 
     //==============================================================================
+    // Programs are curve slots, A to H, for comparing curves. Each keeps its own curve; the
+    // other settings are shared. Every slot's cascade and dynamics stay designed on the design
+    // thread, so processBlock switches by gliding to a bank it already has, in the same time
+    // whatever the curves hold. Switching also queues a design of the slot's own, which
+    // brings auto-fit, the FIR kernel and the morph up to date with it.
     int getNumPrograms() override;
     int getCurrentProgram() override;
     void setCurrentProgram (int index) override;
@@ -53,7 +76,185 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    //==============================================================================
+    // Message thread: queue a redesign for a new curve, the current slot's. Designs run on
+    // the shared design thread, and edits that arrive while it's busy are coalesced into the
+    // newest one.
+    void setCurve (const CurveSnapshot& curve);
+    CurveSnapshot getCurve() const;
+
+    // Audio thread: the curve the engine is currently running
+    const CurveSnapshot& getActiveCurve() const { return _designs.getReadBuffer().curve; }
+
+    // Message thread: linear-phase mode runs the curve as a windowed FIR instead of the
+    // biquad cascade. Its latency (head partition + half the filter length) is reported to the host.
+    // The audio thread switches over once the design thread has published a kernel.
+    void setLinearPhase (bool shouldBeLinearPhase);
+    bool isLinearPhase() const { return _linear_phase.load(); }
+    void setFirLength (int numTaps);
+    int getFirLength() const { return _fir_length.load(); }
+
+    // Message thread: auto-fit designs the cascade from as few parametric sections as match
+    // the curve to within the tolerance, instead of one section per dot
+    void setAutoFit (bool shouldAutoFit);
+    bool isAutoFit() const { return _auto_fit.load(); }
+    void setFitTolerance (float toleranceDb);
+    float getFitTolerance() const { return _fit_tolerance_db.load(); }
+
+    // Message thread: runs the cascade at 2, 4 or 8 times the host rate (1 for off), which keeps
+    // its response from cramping near Nyquist. The half-band filters' latency is reported to
+    // the host. Changing it re-prepares the processor, with processing suspended meanwhile.
+    void setOversampling (int factor);
+    int getOversampling() const { return _oversampling.load(); }
+
+    // Message thread: MIDI morphs the cascade from the curve towards a second, stored one,
+    // through a table of designs made on the design thread (see CurveMorph). Blocks are
+    // split at the MIDI events that move the morph, and the cascade glides from each
+    // event's sample. A target with fewer than two dots, or Source::Off, stops morphing.
+    // Linear-phase mode ignores the morph.
+    void setMorphTarget (const CurveSnapshot& target);
+    CurveSnapshot getMorphTarget() const;
+    void setMorphSettings (const MorphSettings& settings);
+    MorphSettings getMorphSettings() const;
+
+    // Message thread: the curve and every setting above, as saved to and loaded from preset files
+    CurvePreset getPreset() const;
+    void getPreset (CurvePreset& preset) const; // Into one that's already there, off the stack
+    void setPreset (const CurvePreset& preset);
+    // Goes up whenever a preset, a restored state or a slot switch replaces the curve and
+    // settings wholesale, so the editor knows to re-read them all
+    juce::uint32 getStateVersion() const { return _state_version.load(); }
+
+    // Tail blocks the FIR worker thread failed to deliver in time
+    juce::uint32 getNumFirDeadlineMisses() const { return _convolver.getNumDeadlineMisses(); }
+
+    // Any thread
+    DesignMetrics getDesignMetrics() const;
+
+    // The host-automatable breakpoints, after the drawn curve (see BreakpointBands)
+    BreakpointBands& getBreakpoints() { return _breakpoints; }
+    juce::AudioProcessorValueTreeState& getParameters() { return _parameters; }
+
+    // Any thread: processBlock's timing and the bad samples it has seen since prepareToPlay
+    PerformanceCounters& getPerformanceCounters() { return _counters; }
+
+    // Message thread: the editor's copy of the latest design, for drawing the real response.
+    // updateDisplayDesign() returns true if a newer one has arrived since the last call.
+    bool updateDisplayDesign() { return _display_designs.update(); }
+    const CurveDesign& getDisplayDesign() const { return _display_designs.getReadBuffer(); }
+
+    // Message thread: spectra of the input and output. The editor enables them while it's open.
+    SpectrumAnalyzer& getPreAnalyzer() { return _pre_analyzer; }
+    SpectrumAnalyzer& getPostAnalyzer() { return _post_analyzer; }
+
 private:
     //==============================================================================
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    static CurveSnapshot getFlatCurve();
+    double getDesignSampleRate() const;
+    void submitDesign();
+    void designAndPublish (const DesignRequest& request);
+    void designBank (const CurveSnapshot& curve, double sampleRate, bool autoFit, float toleranceDb, CoefficientBank& bank);
+    void publishKernel (const CurveSnapshot& curve, double sampleRate, int firLength);
+    void updateSlotDesigns (int except, double sampleRate, int oversampling);
+    void switchSlot (int index);
+    void updateLatency();
+    void processOversampled (juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+    void processCascade (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages);
+    void processCascadeRange (juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+    void setMorphPosition (float position);
+    bool isMorphing() const;
+
+    // Applies a state or a slot switch staged from another thread
+    void handleAsyncUpdate() override;
+
+    EqEngine _eq;
+
+    // Last curve received from the editor, and the curve MIDI morphs towards (both under the lock)
+    CurveSnapshot _curve;
+    CurveSnapshot _morph_target;
+    juce::CriticalSection _curve_lock;
+
+    // Curve slots. _curve is the current one's, and the others are kept here (curve lock).
+    // A slot's version goes up, under the lock, whenever its curve changes, so the design
+    // thread only redesigns the slots that did, and processBlock only switches to a slot
+    // once its design has caught up.
+    std::array<CurveSnapshot, SlotDesigns::NUM_SLOTS> _slots;
+    std::array<std::atomic<juce::uint32>, SlotDesigns::NUM_SLOTS> _slot_versions {};
+    std::atomic<int> _current_slot { 0 };
+    std::atomic<int> _requested_slot { -1 }; // setCurrentProgram() off the message thread, for handleAsyncUpdate()
+    std::atomic<juce::uint32> _state_version { 0 };
+
+    // Serialises everything that designs and publishes (the design thread, and prepareToPlay
+    // which some hosts call from elsewhere), so each triple buffer still sees a single
+    // writer at a time. Neither the audio thread nor the message thread takes it.
+    juce::CriticalSection _design_lock;
+
+    // Designs are made on the design thread and picked up by processBlock wait-free.
+    // Each one is also copied to the editor through a second buffer of its own.
+    TripleBuffer<CurveDesign> _designs;
+    TripleBuffer<CurveDesign> _display_designs;
+
+    // Every slot's designs, kept up to date under the design lock and copied whole to
+    // processBlock ahead of each design. processBlock ignores designs for any slot but the
+    // one it's running.
+    SlotDesigns _slot_design_cache;
+    TripleBuffer<SlotDesigns> _slot_designs;
+    int _running_slot = 0; // Audio thread only
+
+    // Linear-phase path; the convolver owns the FIR kernels' triple buffers and its tail worker
+    NonUniformConvolver _convolver;
+    FirDesigner _fir_designer;
+    std::atomic<bool> _linear_phase { false };     // As requested by the editor
+    std::atomic<bool> _run_linear_phase { false }; // Set once the kernel for it is published
+    bool _was_linear_phase = false; // Audio thread only
+    std::atomic<int> _fir_length { 16384 };
+
+    // Auto-fit; the fitter keeps its last solution to start the next fit from (design lock)
+    CurveFitter _curve_fitter;
+    std::atomic<bool> _auto_fit { false };
+    std::atomic<float> _fit_tolerance_db { 0.5f };
+
+    // Wraps the cascade only; the linear-phase path always runs at the host rate
+    Oversampler _oversampler;
+    std::atomic<int> _oversampling { 1 };
+
+    // MIDI morph. Tables are published before the design they go with, so once processBlock
+    // has picked up a design, the table it updates to is at least as new.
+    TripleBuffer<MorphTable> _morph_tables;
+    std::atomic<int> _morph_source { (int) MorphSettings::Source::Off };
+    std::atomic<int> _morph_controller { 1 };
+    std::atomic<int> _morph_low_note { 36 }, _morph_high_note { 96 };
+    float _morph_position = 0.0f; // Audio thread only, like the bank interpolated for it
+    CoefficientBank _morph_bank;
+    int _morph_slot = 0; // The slot whose design the table came with
+
+    // Host parameters, read on the audio thread through the atomics the bands cache
+    juce::AudioProcessorValueTreeState _parameters { *this, nullptr, "Parameters", createParameterLayout() };
+
+    // Breakpoints, then dynamic dots, after either path at the host rate. Minimum phase,
+    // even in linear-phase mode.
+    BreakpointBands _breakpoints;
+    DynamicBands _dynamics;
+
+    SpectrumAnalyzer _pre_analyzer, _post_analyzer;
+    PerformanceCounters _counters;
+
+    // Saved and restored states go through these rather than presets on the stack, since
+    // hosts call from threads of their own. Off the message thread, setStateInformation()
+    // swaps what it read into _staged_state for handleAsyncUpdate() to apply.
+    juce::CriticalSection _state_lock;
+    std::unique_ptr<CurvePreset> _state_preset = std::make_unique<CurvePreset>();
+    std::unique_ptr<CurvePreset> _staged_state = std::make_unique<CurvePreset>();
+    bool _state_pending = false;
+
+    // Written by processBlock as it picks up each design
+    std::atomic<float> _design_latency_ms { 0.0f };
+    std::atomic<float> _max_design_latency_ms { 0.0f };
+
+    // Declared last so it's destroyed first: its destructor waits out a design in progress,
+    // which still needs everything above
+    DesignWorker _design_worker { [this] (const DesignRequest& request) { designAndPublish (request); } };
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Juce_sandboxAudioProcessor)
 };
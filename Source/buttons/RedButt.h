@@ -11,6 +11,7 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "../debug/Trace.h"
 
 //==============================================================================
 /*
@@ -43,7 +44,7 @@ public:
         // Optional: Draw an outline
         g.setColour(juce::Colours::black.withAlpha(0.5f));
         g.drawRoundedRectangle(bounds, 6.0f, 1.0f);
-        std::cout << ".";
+        DRAW_TRACE("RedButt background");
     }
 };
 
@@ -0,0 +1,89 @@
+#include <JuceHeader.h>
+#include "Trace.h"
+
+#if DRAW_TRACE_ENABLED
+
+#include <cstdarg>
+
+JUCE_IMPLEMENT_SINGLETON(TraceLog)
+
+TraceLog::TraceLog()
+    : juce::Thread("Trace log")
+{
+    for (juce::uint32 i = 0; i < (juce::uint32)NUM_SLOTS; ++i)
+        _slots[i].sequence.store(i, std::memory_order_relaxed);
+
+    startThread(juce::Thread::Priority::background);
+}
+
+TraceLog::~TraceLog()
+{
+    stopThread(1000);
+    drain();
+    clearSingletonInstance();
+}
+
+void TraceLog::write(const char* format, ...)
+{
+    auto pos = _write_pos.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+
+    // Claim a slot
+    for (;;)
+    {
+        slot = &_slots[pos % NUM_SLOTS];
+        const auto sequence = slot->sequence.load(std::memory_order_acquire);
+        const auto diff = (juce::int32)(sequence - pos);
+
+        if (diff == 0)
+        {
+            if (_write_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            pos = _write_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    va_list args;
+    va_start(args, format);
+    std::vsnprintf(slot->text, MESSAGE_SIZE, format, args);
+    va_end(args);
+
+    slot->sequence.store(pos + 1, std::memory_order_release);
+}
+
+void TraceLog::run()
+{
+    while (! threadShouldExit())
+    {
+        // Polled rather than notified, so write() never touches a lock
+        wait(20);
+        drain();
+    }
+}
+
+void TraceLog::drain()
+{
+    for (;;)
+    {
+        auto& slot = _slots[_read_pos % NUM_SLOTS];
+        if (slot.sequence.load(std::memory_order_acquire) != _read_pos + 1)
+            break;
+
+        juce::Logger::outputDebugString(slot.text);
+        slot.sequence.store(_read_pos + NUM_SLOTS, std::memory_order_release);
+        ++_read_pos;
+    }
+
+    if (const auto dropped = _dropped.exchange(0, std::memory_order_relaxed))
+        juce::Logger::outputDebugString("(" + juce::String(dropped) + " trace messages dropped)");
+}
+
+#endif
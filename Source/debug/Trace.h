@@ -0,0 +1,67 @@
+/* Compile-time switchable trace logging for hot UI paths */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstdio>
+
+// On in Debug builds unless the project says otherwise
+#ifndef DRAW_TRACE_ENABLED
+ #if JUCE_DEBUG
+  #define DRAW_TRACE_ENABLED 1
+ #else
+  #define DRAW_TRACE_ENABLED 0
+ #endif
+#endif
+
+#if DRAW_TRACE_ENABLED
+
+#include <array>
+#include <atomic>
+
+/* DRAW_TRACE("fmt", ...) formats printf-style into a slot of a fixed ring and returns:
+   no locks, no allocation, no I/O on the calling thread. A background thread drains
+   the ring into juce::Logger::outputDebugString (the IDE's output pane, or stderr).
+   Any thread may trace; if the ring is full the message is dropped and counted. */
+class TraceLog : private juce::Thread,
+                 private juce::DeletedAtShutdown
+{
+public:
+    static constexpr int NUM_SLOTS = 1024;
+    static constexpr int MESSAGE_SIZE = 240;
+
+    TraceLog();
+    ~TraceLog() override;
+
+   #if defined (__GNUC__)
+    __attribute__ ((format (printf, 2, 3)))
+   #endif
+    void write(const char* format, ...);
+
+    // Recreated on demand: hosts keep the plugin loaded after DeletedAtShutdown has run for
+    // its last instance, and the next instance still traces
+    JUCE_DECLARE_SINGLETON(TraceLog, false)
+
+private:
+    void run() override;
+    void drain();
+
+    // Bounded multi-producer ring: a slot is free for position p when its sequence is p,
+    // and holds a message for position p when its sequence is p + 1
+    struct Slot
+    {
+        std::atomic<juce::uint32> sequence{ 0 };
+        char text[MESSAGE_SIZE];
+    };
+
+    std::array<Slot, NUM_SLOTS> _slots;
+    std::atomic<juce::uint32> _write_pos{ 0 };
+    juce::uint32 _read_pos = 0; // Drain thread only
+    std::atomic<juce::uint32> _dropped{ 0 };
+};
+
+ #define DRAW_TRACE(...) TraceLog::getInstance()->write(__VA_ARGS__)
+#else
+ // Compiled out: the arguments are still type-checked against the format, but never evaluated
+ #define DRAW_TRACE(...) do { if (false) std::printf(__VA_ARGS__); } while (false)
+#endif
@@ -0,0 +1,119 @@
+#include <JuceHeader.h>
+#include <cmath>
+#include "Biquad.h"
+
+namespace
+{
+    // Keep designs away from DC and Nyquist, where the bilinear transform degenerates
+    double clampFrequency(double freq, double sampleRate)
+    {
+        return juce::jlimit(1.0, sampleRate * 0.49, freq);
+    }
+
+    template <typename T>
+    BiquadCoefficients<T> normalise(double b0, double b1, double b2, double a0, double a1, double a2)
+    {
+        BiquadCoefficients<T> bq;
+        bq.b0 = static_cast<T>(b0 / a0);
+        bq.b1 = static_cast<T>(b1 / a0);
+        bq.b2 = static_cast<T>(b2 / a0);
+        bq.a1 = static_cast<T>(a1 / a0);
+        bq.a2 = static_cast<T>(a2 / a0);
+        return bq;
+    }
+}
+
+template <typename T>
+BiquadCoefficients<T> BiquadCoefficients<T>::peaking(double sampleRate, double freq, double q, double gainDb)
+{
+    const double A = std::pow(10.0, gainDb / 40.0);
+    const double w0 = juce::MathConstants<double>::twoPi * clampFrequency(freq, sampleRate) / sampleRate;
+    const double cosw = std::cos(w0);
+    const double alpha = std::sin(w0) / (2.0 * q);
+
+    return normalise<T>(1.0 + alpha * A, -2.0 * cosw, 1.0 - alpha * A,
+                        1.0 + alpha / A, -2.0 * cosw, 1.0 - alpha / A);
+}
+
+template <typename T>
+BiquadCoefficients<T> BiquadCoefficients<T>::lowShelf(double sampleRate, double freq, double q, double gainDb)
+{
+    const double A = std::pow(10.0, gainDb / 40.0);
+    const double w0 = juce::MathConstants<double>::twoPi * clampFrequency(freq, sampleRate) / sampleRate;
+    const double cosw = std::cos(w0);
+    const double beta = 2.0 * std::sqrt(A) * std::sin(w0) / (2.0 * q);
+
+    return normalise<T>(A * ((A + 1.0) - (A - 1.0) * cosw + beta),
+                        2.0 * A * ((A - 1.0) - (A + 1.0) * cosw),
+                        A * ((A + 1.0) - (A - 1.0) * cosw - beta),
+                        (A + 1.0) + (A - 1.0) * cosw + beta,
+                        -2.0 * ((A - 1.0) + (A + 1.0) * cosw),
+                        (A + 1.0) + (A - 1.0) * cosw - beta);
+}
+
+template <typename T>
+BiquadCoefficients<T> BiquadCoefficients<T>::highShelf(double sampleRate, double freq, double q, double gainDb)
+{
+    const double A = std::pow(10.0, gainDb / 40.0);
+    const double w0 = juce::MathConstants<double>::twoPi * clampFrequency(freq, sampleRate) / sampleRate;
+    const double cosw = std::cos(w0);
+    const double beta = 2.0 * std::sqrt(A) * std::sin(w0) / (2.0 * q);
+
+    return normalise<T>(A * ((A + 1.0) + (A - 1.0) * cosw + beta),
+                        -2.0 * A * ((A - 1.0) + (A + 1.0) * cosw),
+                        A * ((A + 1.0) + (A - 1.0) * cosw - beta),
+                        (A + 1.0) - (A - 1.0) * cosw + beta,
+                        2.0 * ((A - 1.0) - (A + 1.0) * cosw),
+                        (A + 1.0) - (A - 1.0) * cosw - beta);
+}
+
+template <typename T>
+BiquadCoefficients<T> BiquadCoefficients<T>::bandPass(double sampleRate, double freq, double q)
+{
+    const double w0 = juce::MathConstants<double>::twoPi * clampFrequency(freq, sampleRate) / sampleRate;
+    const double cosw = std::cos(w0);
+    const double alpha = std::sin(w0) / (2.0 * q);
+
+    return normalise<T>(alpha, 0.0, -alpha, 1.0 + alpha, -2.0 * cosw, 1.0 - alpha);
+}
+
+template <typename T>
+BiquadCoefficients<T> BiquadCoefficients<T>::lowPass(double sampleRate, double freq, double q)
+{
+    const double w0 = juce::MathConstants<double>::twoPi * clampFrequency(freq, sampleRate) / sampleRate;
+    const double cosw = std::cos(w0);
+    const double alpha = std::sin(w0) / (2.0 * q);
+
+    return normalise<T>((1.0 - cosw) / 2.0, 1.0 - cosw, (1.0 - cosw) / 2.0, 1.0 + alpha, -2.0 * cosw, 1.0 - alpha);
+}
+
+template <typename T>
+BiquadCoefficients<T> BiquadCoefficients<T>::highPass(double sampleRate, double freq, double q)
+{
+    const double w0 = juce::MathConstants<double>::twoPi * clampFrequency(freq, sampleRate) / sampleRate;
+    const double cosw = std::cos(w0);
+    const double alpha = std::sin(w0) / (2.0 * q);
+
+    return normalise<T>((1.0 + cosw) / 2.0, -(1.0 + cosw), (1.0 + cosw) / 2.0, 1.0 + alpha, -2.0 * cosw, 1.0 - alpha);
+}
+
+template <typename T>
+double BiquadCoefficients<T>::magnitudeDb(double freq, double sampleRate) const
+{
+    const double w = juce::MathConstants<double>::twoPi * freq / sampleRate;
+    const double c1 = std::cos(w), s1 = std::sin(w);
+    const double c2 = std::cos(2.0 * w), s2 = std::sin(2.0 * w);
+
+    const double num_re = b0 + b1 * c1 + b2 * c2;
+    const double num_im = -(b1 * s1 + b2 * s2);
+    const double den_re = 1.0 + a1 * c1 + a2 * c2;
+    const double den_im = -(a1 * s1 + a2 * s2);
+
+    const double num = num_re * num_re + num_im * num_im;
+    const double den = den_re * den_re + den_im * den_im;
+
+    return 10.0 * std::log10(std::max(num, 1e-30) / std::max(den, 1e-30));
+}
+
+template struct BiquadCoefficients<float>;
+template struct BiquadCoefficients<double>;
@@ -0,0 +1,29 @@
+/* Biquad coefficient design (RBJ audio EQ cookbook), normalised so a0 == 1 */
+
+#pragma once
+
+template <typename T>
+struct BiquadCoefficients
+{
+    T b0 = 1, b1 = 0, b2 = 0;
+    T a1 = 0, a2 = 0;
+
+    static BiquadCoefficients peaking(double sampleRate, double freq, double q, double gainDb);
+    static BiquadCoefficients lowShelf(double sampleRate, double freq, double q, double gainDb);
+    static BiquadCoefficients highShelf(double sampleRate, double freq, double q, double gainDb);
+
+    // Unity gain at the centre (band pass) or in the passband
+    static BiquadCoefficients bandPass(double sampleRate, double freq, double q);
+    static BiquadCoefficients lowPass(double sampleRate, double freq, double q);
+    static BiquadCoefficients highPass(double sampleRate, double freq, double q);
+
+    // Magnitude response in dB at the given frequency
+    double magnitudeDb(double freq, double sampleRate) const;
+};
+
+// What the engine runs
+using Biquad = BiquadCoefficients<float>;
+
+// Unrounded, for when float rounding would swamp small parameter changes: at low
+// frequencies the response of float coefficients is only good to a tenth of a dB or so
+using PreciseBiquad = BiquadCoefficients<double>;
@@ -0,0 +1,486 @@
+#include <JuceHeader.h>
+#include "BiquadCascade.h"
+#include <utility>
+
+#if defined (__AVX2__)
+ #include <immintrin.h>
+ #define DRAW_CASCADE_AVX2 1
+#elif defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define DRAW_CASCADE_SSE2 1
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__) || defined (_M_ARM64)
+ #include <arm_neon.h>
+ #define DRAW_CASCADE_NEON 1
+#endif
+
+namespace
+{
+    //==========================
+    // Minimal lane wrappers: only what the kernels need
+
+   #if DRAW_CASCADE_AVX2
+    struct Lanes
+    {
+        using V = __m256;
+        using Mask = __m256;
+        static constexpr int WIDTH = 8;
+
+        static V load(const float* p)           { return _mm256_loadu_ps(p); }
+        static void store(float* p, V v)        { _mm256_storeu_ps(p, v); }
+        static V zero()                         { return _mm256_setzero_ps(); }
+        static V broadcast(float x)             { return _mm256_set1_ps(x); }
+        static V add(V a, V b)                  { return _mm256_add_ps(a, b); }
+        static V sub(V a, V b)                  { return _mm256_sub_ps(a, b); }
+        static V mul(V a, V b)                  { return _mm256_mul_ps(a, b); }
+        static V select(Mask m, V a, V b)       { return _mm256_blendv_ps(b, a, m); }
+        static V laneIndex()                    { return _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f); }
+
+        // [x0, y0, y1, ... y6]
+        static V shiftIn(V y, float x0)
+        {
+            const auto shifted = _mm256_permutevar8x32_ps(y, _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6));
+            return _mm256_blend_ps(shifted, _mm256_set1_ps(x0), 1);
+        }
+
+        static float last(V v)
+        {
+            const auto high = _mm256_extractf128_ps(v, 1);
+            return _mm_cvtss_f32(_mm_shuffle_ps(high, high, _MM_SHUFFLE(3, 3, 3, 3)));
+        }
+
+        // Lanes k with 0 <= t - k < numSamples
+        static Mask activeMask(int t, int numSamples)
+        {
+            const auto lane = laneIndex();
+            return _mm256_and_ps(_mm256_cmp_ps(lane, _mm256_set1_ps((float)t), _CMP_LE_OQ),
+                                 _mm256_cmp_ps(lane, _mm256_set1_ps((float)(t - numSamples)), _CMP_GT_OQ));
+        }
+    };
+   #elif DRAW_CASCADE_SSE2
+    struct Lanes
+    {
+        using V = __m128;
+        using Mask = __m128;
+        static constexpr int WIDTH = 4;
+
+        static V load(const float* p)           { return _mm_loadu_ps(p); }
+        static void store(float* p, V v)        { _mm_storeu_ps(p, v); }
+        static V zero()                         { return _mm_setzero_ps(); }
+        static V broadcast(float x)             { return _mm_set1_ps(x); }
+        static V add(V a, V b)                  { return _mm_add_ps(a, b); }
+        static V sub(V a, V b)                  { return _mm_sub_ps(a, b); }
+        static V mul(V a, V b)                  { return _mm_mul_ps(a, b); }
+        static V select(Mask m, V a, V b)       { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+        static V laneIndex()                    { return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f); }
+
+        // [x0, y0, y1, y2]
+        static V shiftIn(V y, float x0)
+        {
+            const auto shifted = _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(y), 4));
+            return _mm_move_ss(shifted, _mm_set_ss(x0));
+        }
+
+        static float last(V v)                  { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))); }
+
+        static Mask activeMask(int t, int numSamples)
+        {
+            const auto lane = laneIndex();
+            return _mm_and_ps(_mm_cmple_ps(lane, _mm_set1_ps((float)t)),
+                              _mm_cmpgt_ps(lane, _mm_set1_ps((float)(t - numSamples))));
+        }
+    };
+   #elif DRAW_CASCADE_NEON
+    struct Lanes
+    {
+        using V = float32x4_t;
+        using Mask = uint32x4_t;
+        static constexpr int WIDTH = 4;
+
+        static V load(const float* p)           { return vld1q_f32(p); }
+        static void store(float* p, V v)        { vst1q_f32(p, v); }
+        static V zero()                         { return vdupq_n_f32(0.0f); }
+        static V broadcast(float x)             { return vdupq_n_f32(x); }
+        static V add(V a, V b)                  { return vaddq_f32(a, b); }
+        static V sub(V a, V b)                  { return vsubq_f32(a, b); }
+        static V mul(V a, V b)                  { return vmulq_f32(a, b); }
+        static V select(Mask m, V a, V b)       { return vbslq_f32(m, a, b); }
+
+        static V laneIndex()
+        {
+            const float index[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+            return vld1q_f32(index);
+        }
+
+        // [x0, y0, y1, y2]
+        static V shiftIn(V y, float x0)         { return vextq_f32(vdupq_n_f32(x0), y, 3); }
+        static float last(V v)                  { return vgetq_lane_f32(v, 3); }
+
+        static Mask activeMask(int t, int numSamples)
+        {
+            const auto lane = laneIndex();
+            return vandq_u32(vcleq_f32(lane, vdupq_n_f32((float)t)),
+                             vcgtq_f32(lane, vdupq_n_f32((float)(t - numSamples))));
+        }
+    };
+   #endif
+
+   #if DRAW_CASCADE_AVX2 || DRAW_CASCADE_SSE2 || DRAW_CASCADE_NEON
+    // With Ramp, every coefficient moves by step's value after each sample
+    template <bool Ramp>
+    void processStaggered(const CoefficientBank& bank, const CoefficientBank* step, float* z1, float* z2, float* data, int numSamples)
+    {
+        using V = Lanes::V;
+        constexpr int W = Lanes::WIDTH;
+
+        const int numGroups = (bank.num_sections + W - 1) / W;
+        const int numSteps = numSamples + W - 1;
+
+        for (int g = 0; g < numGroups; ++g)
+        {
+            const int base = g * W;
+            V b0 = Lanes::load(&bank.b0[base]);
+            V b1 = Lanes::load(&bank.b1[base]);
+            V b2 = Lanes::load(&bank.b2[base]);
+            V a1 = Lanes::load(&bank.a1[base]);
+            V a2 = Lanes::load(&bank.a2[base]);
+
+            V db0{}, db1{}, db2{}, da1{}, da2{};
+            if (Ramp)
+            {
+                db0 = Lanes::load(&step->b0[base]);
+                db1 = Lanes::load(&step->b1[base]);
+                db2 = Lanes::load(&step->b2[base]);
+                da1 = Lanes::load(&step->a1[base]);
+                da2 = Lanes::load(&step->a2[base]);
+
+                // Lane k reaches sample 0 at step k, so it starts k steps behind
+                const V lag = Lanes::laneIndex();
+                b0 = Lanes::sub(b0, Lanes::mul(db0, lag));
+                b1 = Lanes::sub(b1, Lanes::mul(db1, lag));
+                b2 = Lanes::sub(b2, Lanes::mul(db2, lag));
+                a1 = Lanes::sub(a1, Lanes::mul(da1, lag));
+                a2 = Lanes::sub(a2, Lanes::mul(da2, lag));
+            }
+
+            auto advanceCoefficients = [&]
+            {
+                if (Ramp)
+                {
+                    b0 = Lanes::add(b0, db0);
+                    b1 = Lanes::add(b1, db1);
+                    b2 = Lanes::add(b2, db2);
+                    a1 = Lanes::add(a1, da1);
+                    a2 = Lanes::add(a2, da2);
+                }
+            };
+
+            V s1 = Lanes::load(z1 + base);
+            V s2 = Lanes::load(z2 + base);
+            V y = Lanes::zero(); // Each lane's output from the previous step
+
+            // Ramp-in/ramp-out steps: only lanes with a real sample advance
+            auto maskedStep = [&](int t)
+            {
+                const auto active = Lanes::activeMask(t, numSamples);
+                const V x = Lanes::shiftIn(y, t < numSamples ? data[t] : 0.0f);
+                const V out = Lanes::add(Lanes::mul(b0, x), s1);
+                const V n1 = Lanes::sub(Lanes::add(Lanes::mul(b1, x), s2), Lanes::mul(a1, out));
+                const V n2 = Lanes::sub(Lanes::mul(b2, x), Lanes::mul(a2, out));
+
+                s1 = Lanes::select(active, n1, s1);
+                s2 = Lanes::select(active, n2, s2);
+                y = Lanes::select(active, out, Lanes::zero());
+                advanceCoefficients();
+
+                if (t >= W - 1)
+                    data[t - (W - 1)] = Lanes::last(y);
+            };
+
+            int t = 0;
+            for (; t < W - 1; ++t)
+                maskedStep(t);
+
+            // Steady state: every lane busy. Writing behind the read position keeps this in-place safe.
+            for (; t < numSamples; ++t)
+            {
+                const V x = Lanes::shiftIn(y, data[t]);
+                y = Lanes::add(Lanes::mul(b0, x), s1);
+                s1 = Lanes::sub(Lanes::add(Lanes::mul(b1, x), s2), Lanes::mul(a1, y));
+                s2 = Lanes::sub(Lanes::mul(b2, x), Lanes::mul(a2, y));
+                advanceCoefficients();
+                data[t - (W - 1)] = Lanes::last(y);
+            }
+
+            for (; t < numSteps; ++t)
+                maskedStep(t);
+
+            Lanes::store(z1 + base, s1);
+            Lanes::store(z2 + base, s2);
+        }
+    }
+
+    template <int... Index, typename Fn>
+    inline void forEachVector(std::integer_sequence<int, Index...>, Fn&& fn)
+    {
+        (fn(Index), ...);
+    }
+
+    // Channels go through the block in chunks of this many samples, interleaved one lane each
+    constexpr int CHANNEL_CHUNK = 64;
+
+    // Up to N * WIDTH channels, lane per channel, N vectors stepping together. Lanes past
+    // numChannels run silence and are dropped.
+    template <bool Ramp, int N>
+    void processChannelGroup(const CoefficientBank& bank, const CoefficientBank* step, float* z1, float* z2,
+                             float* const* channels, int numChannels, int startSample, int numSamples)
+    {
+        using V = Lanes::V;
+        constexpr int W = Lanes::WIDTH;
+        constexpr int LANES = N * W;
+
+        alignas(W * sizeof(float)) float block[CHANNEL_CHUNK * LANES];
+        alignas(W * sizeof(float)) float state1[LANES], state2[LANES];
+
+        for (int offset = 0; offset < numSamples; offset += CHANNEL_CHUNK)
+        {
+            const int count = juce::jmin(CHANNEL_CHUNK, numSamples - offset);
+
+            for (int c = 0; c < LANES; ++c)
+            {
+                const float* in = c < numChannels ? channels[c] + startSample + offset : nullptr;
+                for (int t = 0; t < count; ++t)
+                    block[t * LANES + c] = in != nullptr ? in[t] : 0.0f;
+            }
+
+            // Section-major over the chunk, as processScalar(), with N recursions in flight
+            for (int s = 0; s < bank.num_sections; ++s)
+            {
+                for (int c = 0; c < LANES; ++c)
+                {
+                    state1[c] = c < numChannels ? z1[c * CoefficientBank::MAX_SECTIONS + s] : 0.0f;
+                    state2[c] = c < numChannels ? z2[c * CoefficientBank::MAX_SECTIONS + s] : 0.0f;
+                }
+
+                V s1[N], s2[N];
+                for (int n = 0; n < N; ++n)
+                {
+                    s1[n] = Lanes::load(state1 + n * W);
+                    s2[n] = Lanes::load(state2 + n * W);
+                }
+
+                // Every lane is at the same sample, so the coefficients are plain broadcasts
+                const float lag = Ramp ? (float)offset : 0.0f;
+                V b0 = Lanes::broadcast(bank.b0[s] + (Ramp ? step->b0[s] * lag : 0.0f));
+                V b1 = Lanes::broadcast(bank.b1[s] + (Ramp ? step->b1[s] * lag : 0.0f));
+                V b2 = Lanes::broadcast(bank.b2[s] + (Ramp ? step->b2[s] * lag : 0.0f));
+                V a1 = Lanes::broadcast(bank.a1[s] + (Ramp ? step->a1[s] * lag : 0.0f));
+                V a2 = Lanes::broadcast(bank.a2[s] + (Ramp ? step->a2[s] * lag : 0.0f));
+
+                V db0{}, db1{}, db2{}, da1{}, da2{};
+                if (Ramp)
+                {
+                    db0 = Lanes::broadcast(step->b0[s]);
+                    db1 = Lanes::broadcast(step->b1[s]);
+                    db2 = Lanes::broadcast(step->b2[s]);
+                    da1 = Lanes::broadcast(step->a1[s]);
+                    da2 = Lanes::broadcast(step->a2[s]);
+                }
+
+                auto vectorStep = [&](V& z1v, V& z2v, float* p)
+                {
+                    const V x = Lanes::load(p);
+                    const V y = Lanes::add(Lanes::mul(b0, x), z1v);
+                    z1v = Lanes::sub(Lanes::add(Lanes::mul(b1, x), z2v), Lanes::mul(a1, y));
+                    z2v = Lanes::sub(Lanes::mul(b2, x), Lanes::mul(a2, y));
+                    Lanes::store(p, y);
+                };
+
+                for (int t = 0; t < count; ++t)
+                {
+                    // Spelled out per vector: as a loop, compilers tend to keep the state in memory
+                    float* row = block + t * LANES;
+                    forEachVector(std::make_integer_sequence<int, N>(), [&](int n) { vectorStep(s1[n], s2[n], row + n * W); });
+
+                    if (Ramp)
+                    {
+                        b0 = Lanes::add(b0, db0);
+                        b1 = Lanes::add(b1, db1);
+                        b2 = Lanes::add(b2, db2);
+                        a1 = Lanes::add(a1, da1);
+                        a2 = Lanes::add(a2, da2);
+                    }
+                }
+
+                for (int n = 0; n < N; ++n)
+                {
+                    Lanes::store(state1 + n * W, s1[n]);
+                    Lanes::store(state2 + n * W, s2[n]);
+                }
+
+                for (int c = 0; c < numChannels; ++c)
+                {
+                    z1[c * CoefficientBank::MAX_SECTIONS + s] = state1[c];
+                    z2[c * CoefficientBank::MAX_SECTIONS + s] = state2[c];
+                }
+            }
+
+            for (int c = 0; c < numChannels; ++c)
+            {
+                float* out = channels[c] + startSample + offset;
+                for (int t = 0; t < count; ++t)
+                    out[t] = block[t * LANES + c];
+            }
+        }
+    }
+
+    // The fewest vectors, up to N, that cover numChannels, so a small remainder doesn't run empty lanes
+    template <bool Ramp, int N>
+    void processChannelVectors(const CoefficientBank& bank, const CoefficientBank* step, float* z1, float* z2,
+                               float* const* channels, int numChannels, int startSample, int numSamples)
+    {
+        if constexpr (N > 1)
+        {
+            if (numChannels <= (N - 1) * Lanes::WIDTH)
+                return processChannelVectors<Ramp, N - 1>(bank, step, z1, z2, channels, numChannels, startSample, numSamples);
+        }
+
+        processChannelGroup<Ramp, N>(bank, step, z1, z2, channels, numChannels, startSample, numSamples);
+    }
+
+    template <bool Ramp>
+    void processChannelLanes(const CoefficientBank& bank, const CoefficientBank* step, float* z1, float* z2,
+                             float* const* channels, int numChannels, int startSample, int numSamples)
+    {
+        constexpr int VECTORS = BiquadCascade::CHANNEL_GROUP / Lanes::WIDTH;
+
+        for (int first = 0; first < numChannels; first += BiquadCascade::CHANNEL_GROUP)
+        {
+            processChannelVectors<Ramp, VECTORS>(bank, step,
+                                                 z1 + first * CoefficientBank::MAX_SECTIONS, z2 + first * CoefficientBank::MAX_SECTIONS,
+                                                 channels + first, juce::jmin(BiquadCascade::CHANNEL_GROUP, numChannels - first),
+                                                 startSample, numSamples);
+        }
+    }
+   #endif
+}
+
+int BiquadCascade::getNumLanes()
+{
+   #if DRAW_CASCADE_AVX2 || DRAW_CASCADE_SSE2 || DRAW_CASCADE_NEON
+    return Lanes::WIDTH;
+   #else
+    return 1;
+   #endif
+}
+
+void BiquadCascade::padToLanes(CoefficientBank& bank)
+{
+    const int lanes = getNumLanes();
+    const int padded = juce::jmin(CoefficientBank::MAX_SECTIONS, (bank.num_sections + lanes - 1) / lanes * lanes);
+
+    for (int s = bank.num_sections; s < padded; ++s)
+        bank.setSection(s, Biquad{});
+}
+
+void BiquadCascade::process(const CoefficientBank& bank, float* s1, float* s2, float* data, int numSamples)
+{
+   #if DRAW_CASCADE_AVX2 || DRAW_CASCADE_SSE2 || DRAW_CASCADE_NEON
+    processStaggered<false>(bank, nullptr, s1, s2, data, numSamples);
+   #else
+    processScalar(bank, s1, s2, data, numSamples);
+   #endif
+}
+
+void BiquadCascade::processRamp(const CoefficientBank& start, const CoefficientBank& step, float* s1, float* s2, float* data, int numSamples)
+{
+   #if DRAW_CASCADE_AVX2 || DRAW_CASCADE_SSE2 || DRAW_CASCADE_NEON
+    processStaggered<true>(start, &step, s1, s2, data, numSamples);
+   #else
+    processRampScalar(start, step, s1, s2, data, numSamples);
+   #endif
+}
+
+bool BiquadCascade::prefersChannelLanes(int numChannels)
+{
+   #if DRAW_CASCADE_AVX2 || DRAW_CASCADE_SSE2 || DRAW_CASCADE_NEON
+    return numChannels >= Lanes::WIDTH;
+   #else
+    juce::ignoreUnused(numChannels);
+    return false;
+   #endif
+}
+
+void BiquadCascade::processChannels(const CoefficientBank& bank, float* s1, float* s2,
+                                    float* const* channels, int numChannels, int startSample, int numSamples)
+{
+   #if DRAW_CASCADE_AVX2 || DRAW_CASCADE_SSE2 || DRAW_CASCADE_NEON
+    processChannelLanes<false>(bank, nullptr, s1, s2, channels, numChannels, startSample, numSamples);
+   #else
+    for (int ch = 0; ch < numChannels; ++ch)
+        processScalar(bank, s1 + ch * CoefficientBank::MAX_SECTIONS, s2 + ch * CoefficientBank::MAX_SECTIONS,
+                      channels[ch] + startSample, numSamples);
+   #endif
+}
+
+void BiquadCascade::processChannelsRamp(const CoefficientBank& start, const CoefficientBank& step, float* s1, float* s2,
+                                        float* const* channels, int numChannels, int startSample, int numSamples)
+{
+   #if DRAW_CASCADE_AVX2 || DRAW_CASCADE_SSE2 || DRAW_CASCADE_NEON
+    processChannelLanes<true>(start, &step, s1, s2, channels, numChannels, startSample, numSamples);
+   #else
+    for (int ch = 0; ch < numChannels; ++ch)
+        processRampScalar(start, step, s1 + ch * CoefficientBank::MAX_SECTIONS, s2 + ch * CoefficientBank::MAX_SECTIONS,
+                          channels[ch] + startSample, numSamples);
+   #endif
+}
+
+void BiquadCascade::processScalar(const CoefficientBank& bank, float* z1, float* z2, float* data, int numSamples)
+{
+    // Section-major: run the whole block through one section before the next,
+    // so coefficients and state stay in registers for the inner loop
+    for (int s = 0; s < bank.num_sections; ++s)
+    {
+        const float b0 = bank.b0[s], b1 = bank.b1[s], b2 = bank.b2[s];
+        const float a1 = bank.a1[s], a2 = bank.a2[s];
+        float s1 = z1[s], s2 = z2[s];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float in = data[i];
+            const float out = b0 * in + s1;
+            s1 = (b1 * in + s2) - a1 * out; // Same operation order as the vector kernel
+            s2 = b2 * in - a2 * out;
+            data[i] = out;
+        }
+
+        z1[s] = s1;
+        z2[s] = s2;
+    }
+}
+
+void BiquadCascade::processRampScalar(const CoefficientBank& start, const CoefficientBank& step, float* z1, float* z2, float* data, int numSamples)
+{
+    for (int s = 0; s < start.num_sections; ++s)
+    {
+        float b0 = start.b0[s], b1 = start.b1[s], b2 = start.b2[s];
+        float a1 = start.a1[s], a2 = start.a2[s];
+        const float db0 = step.b0[s], db1 = step.b1[s], db2 = step.b2[s];
+        const float da1 = step.a1[s], da2 = step.a2[s];
+        float s1 = z1[s], s2 = z2[s];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float in = data[i];
+            const float out = b0 * in + s1;
+            s1 = (b1 * in + s2) - a1 * out;
+            s2 = b2 * in - a2 * out;
+            data[i] = out;
+
+            b0 += db0; b1 += db1; b2 += db2;
+            a1 += da1; a2 += da2;
+        }
+
+        z1[s] = s1;
+        z2[s] = s2;
+    }
+}
@@ -0,0 +1,57 @@
+/* Vectorised biquad cascade kernel */
+
+#pragma once
+
+#include "CurveDesigner.h"
+
+/* Runs a whole CoefficientBank over one channel.
+
+   Consecutive sections are packed into SIMD lanes and staggered by one sample
+   (lane k works on sample t - k while lane 0 takes sample t), so a vector step
+   advances LANES sections at once and each lane feeds the next through a lane
+   shift. The first and last LANES - 1 steps of a block only have some lanes in
+   flight and are masked, so the cascade adds no latency and block boundaries are
+   exact. Sections past bank.num_sections must be identity (see padToLanes()).
+
+   For buses with at least as many channels as lanes, processChannels() turns this
+   around: each lane is a channel, all lanes share one section's coefficients, and up
+   to CHANNEL_GROUP channels step together (four SSE/NEON vectors, two AVX2 ones,
+   which measured best) so their recursions hide each other's latency. Every channel
+   keeps its own state.
+
+   Uses AVX2 (8 lanes), SSE2 or NEON (4 lanes) depending on the target, with a
+   plain scalar fallback. */
+class BiquadCascade
+{
+public:
+    static constexpr int MAX_LANES = 8;
+    static constexpr int CHANNEL_GROUP = 16;
+
+    // Number of sections processed per vector step on this build
+    static int getNumLanes();
+
+    // Fills the unused tail of the last lane group with identity sections
+    static void padToLanes(CoefficientBank& bank);
+
+    // s1/s2 hold CoefficientBank::MAX_SECTIONS floats of TDF-II state each
+    static void process(const CoefficientBank& bank, float* s1, float* s2, float* data, int numSamples);
+
+    // Like process(), but sample i runs with coefficients start + i * step. Both banks
+    // cover start.num_sections. Costs five vector adds per step on top of process().
+    static void processRamp(const CoefficientBank& start, const CoefficientBank& step, float* s1, float* s2, float* data, int numSamples);
+
+    // True if processChannels() beats process() per channel for this many channels
+    static bool prefersChannelLanes(int numChannels);
+
+    // Every channel through the same cascade, channels across lanes. Channel ch's state is
+    // s1/s2 + ch * CoefficientBank::MAX_SECTIONS, as for process(); its samples are
+    // channels[ch] + startSample onwards.
+    static void processChannels(const CoefficientBank& bank, float* s1, float* s2,
+                                float* const* channels, int numChannels, int startSample, int numSamples);
+    static void processChannelsRamp(const CoefficientBank& start, const CoefficientBank& step, float* s1, float* s2,
+                                    float* const* channels, int numChannels, int startSample, int numSamples);
+
+    // Reference implementations, one section at a time
+    static void processScalar(const CoefficientBank& bank, float* s1, float* s2, float* data, int numSamples);
+    static void processRampScalar(const CoefficientBank& start, const CoefficientBank& step, float* s1, float* s2, float* data, int numSamples);
+};
@@ -0,0 +1,273 @@
+#include <JuceHeader.h>
+#include <cmath>
+#include "BreakpointBands.h"
+
+namespace
+{
+    Biquad makeSection(double sampleRate, float freq, float q, float gainDb)
+    {
+        // Exactly identity at 0 dB, so resting bands keep their state at zero
+        return gainDb == 0.0f ? Biquad{} : Biquad::peaking(sampleRate, freq, q, gainDb);
+    }
+}
+
+juce::String BreakpointBands::getParameterId(int band, const char* field)
+{
+    return "band" + juce::String(band + 1) + field;
+}
+
+BreakpointSettings BreakpointBands::getDefault(int band)
+{
+    BreakpointSettings settings;
+    settings.freq = MIN_FREQ * std::pow(MAX_FREQ / MIN_FREQ, ((float)band + 0.5f) / (float)NUM_BANDS);
+    return settings;
+}
+
+std::array<BreakpointSettings, BreakpointBands::NUM_BANDS> BreakpointBands::getDefaults()
+{
+    std::array<BreakpointSettings, NUM_BANDS> defaults;
+    for (int band = 0; band < NUM_BANDS; ++band)
+        defaults[(size_t)band] = getDefault(band);
+    return defaults;
+}
+
+void BreakpointBands::addParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout)
+{
+    juce::NormalisableRange<float> freqRange(MIN_FREQ, MAX_FREQ);
+    freqRange.setSkewForCentre(std::sqrt(MIN_FREQ * MAX_FREQ));
+    juce::NormalisableRange<float> gainRange(-MAX_GAIN_DB, MAX_GAIN_DB);
+    juce::NormalisableRange<float> qRange(MIN_Q, MAX_Q);
+    qRange.setSkewForCentre(std::sqrt(MIN_Q * MAX_Q));
+
+    for (int band = 0; band < NUM_BANDS; ++band)
+    {
+        const auto name = "Band " + juce::String(band + 1) + " ";
+        const auto defaults = getDefault(band);
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{ getParameterId(band, "Freq"), 1 }, name + "Freq",
+                                                               freqRange, defaults.freq, juce::AudioParameterFloatAttributes().withLabel("Hz")),
+                   std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{ getParameterId(band, "Gain"), 1 }, name + "Gain",
+                                                               gainRange, defaults.gain_db, juce::AudioParameterFloatAttributes().withLabel("dB")),
+                   std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{ getParameterId(band, "Q"), 1 }, name + "Q",
+                                                               qRange, defaults.q),
+                   std::make_unique<juce::AudioParameterBool>(juce::ParameterID{ getParameterId(band, "On"), 1 }, name + "On",
+                                                              defaults.enabled));
+    }
+}
+
+void BreakpointBands::attach(juce::AudioProcessorValueTreeState& parameters)
+{
+    for (int band = 0; band < NUM_BANDS; ++band)
+    {
+        auto& p = _parameters[(size_t)band];
+        p.freq = parameters.getRawParameterValue(getParameterId(band, "Freq"));
+        p.gain = parameters.getRawParameterValue(getParameterId(band, "Gain"));
+        p.q = parameters.getRawParameterValue(getParameterId(band, "Q"));
+        p.on = parameters.getRawParameterValue(getParameterId(band, "On"));
+        p.freq_parameter = parameters.getParameter(getParameterId(band, "Freq"));
+        p.gain_parameter = parameters.getParameter(getParameterId(band, "Gain"));
+        p.q_parameter = parameters.getParameter(getParameterId(band, "Q"));
+        p.on_parameter = parameters.getParameter(getParameterId(band, "On"));
+        jassert(p.freq != nullptr && p.gain != nullptr && p.q != nullptr && p.on != nullptr);
+    }
+}
+
+BreakpointSettings BreakpointBands::getSettings(int band) const
+{
+    const auto& p = _parameters[(size_t)band];
+    BreakpointSettings settings;
+    settings.freq = p.freq->load(std::memory_order_relaxed);
+    settings.gain_db = p.gain->load(std::memory_order_relaxed);
+    settings.q = p.q->load(std::memory_order_relaxed);
+    settings.enabled = p.on->load(std::memory_order_relaxed) >= 0.5f;
+    return settings;
+}
+
+void BreakpointBands::setSettings(int band, const BreakpointSettings& settings)
+{
+    const auto& p = _parameters[(size_t)band];
+    p.freq_parameter->setValueNotifyingHost(p.freq_parameter->convertTo0to1(settings.freq));
+    p.gain_parameter->setValueNotifyingHost(p.gain_parameter->convertTo0to1(settings.gain_db));
+    p.q_parameter->setValueNotifyingHost(p.q_parameter->convertTo0to1(settings.q));
+    p.on_parameter->setValueNotifyingHost(settings.enabled ? 1.0f : 0.0f);
+}
+
+void BreakpointBands::beginChangeGesture(int band)
+{
+    const auto& p = _parameters[(size_t)band];
+    for (auto* parameter : { p.freq_parameter, p.gain_parameter, p.q_parameter, p.on_parameter })
+        parameter->beginChangeGesture();
+}
+
+void BreakpointBands::endChangeGesture(int band)
+{
+    const auto& p = _parameters[(size_t)band];
+    for (auto* parameter : { p.freq_parameter, p.gain_parameter, p.q_parameter, p.on_parameter })
+        parameter->endChangeGesture();
+}
+
+void BreakpointBands::design(const std::array<BreakpointSettings, NUM_BANDS>& settings, double sampleRate, CoefficientBank& bank)
+{
+    for (int band = 0; band < NUM_BANDS; ++band)
+    {
+        const auto& s = settings[(size_t)band];
+        bank.setSection(band, makeSection(sampleRate, s.freq, s.q, s.enabled ? s.gain_db : 0.0f));
+    }
+
+    bank.num_sections = NUM_BANDS;
+}
+
+void BreakpointBands::prepare(double sampleRate, int numChannels)
+{
+    _sample_rate = sampleRate;
+    _num_channels = numChannels;
+    _smoothing = (float)(1.0 - std::exp(-CONTROL_INTERVAL / (SMOOTHING_SECONDS * sampleRate)));
+
+    _z1.assign(static_cast<size_t>(numChannels) * CoefficientBank::MAX_SECTIONS, 0.0f);
+    _z2.assign(static_cast<size_t>(numChannels) * CoefficientBank::MAX_SECTIONS, 0.0f);
+
+    snapToTargets();
+}
+
+void BreakpointBands::reset()
+{
+    std::fill(_z1.begin(), _z1.end(), 0.0f);
+    std::fill(_z2.begin(), _z2.end(), 0.0f);
+}
+
+void BreakpointBands::snapToTargets()
+{
+    // Force every band to be read, then start there
+    _last_on.fill(-1.0f);
+    readTargets();
+    _log_freq = _target_log_freq;
+    _gain_db = _target_gain_db;
+    _log_q = _target_log_q;
+
+    bool anyActive = false;
+    for (int band = 0; band < NUM_BANDS; ++band)
+    {
+        _sections.targets.setSection(band, makeSection(_sample_rate, std::exp2(_log_freq[(size_t)band]),
+                                                       std::exp2(_log_q[(size_t)band]), _gain_db[(size_t)band]));
+        anyActive = anyActive || _gain_db[(size_t)band] != 0.0f;
+    }
+
+    _sections.targets.num_sections = NUM_BANDS;
+    _sections.snap(anyActive);
+    _until_update = 0;
+    reset();
+}
+
+bool BreakpointBands::readTargets()
+{
+    bool moved = false;
+
+    for (int band = 0; band < NUM_BANDS; ++band)
+    {
+        const auto& p = _parameters[(size_t)band];
+        const float freq = p.freq->load(std::memory_order_relaxed);
+        const float gain = p.gain->load(std::memory_order_relaxed);
+        const float q = p.q->load(std::memory_order_relaxed);
+        const float on = p.on->load(std::memory_order_relaxed);
+
+        const size_t b = (size_t)band;
+        if (freq == _last_freq[b] && gain == _last_gain[b] && q == _last_q[b] && on == _last_on[b])
+            continue;
+
+        _last_freq[b] = freq;
+        _last_gain[b] = gain;
+        _last_q[b] = q;
+        _last_on[b] = on;
+
+        _target_log_freq[b] = std::log2(juce::jlimit(MIN_FREQ, MAX_FREQ, freq));
+        _target_gain_db[b] = on >= 0.5f ? juce::jlimit(-MAX_GAIN_DB, MAX_GAIN_DB, gain) : 0.0f;
+        _target_log_q[b] = std::log2(juce::jlimit(MIN_Q, MAX_Q, q));
+        moved = true;
+    }
+
+    return moved;
+}
+
+void BreakpointBands::process(juce::AudioBuffer<float>& buffer)
+{
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = juce::jmin(buffer.getNumChannels(), _num_channels);
+    if (numChannels == 0)
+        return;
+
+    // The host's parameter changes land at the start of the block: split here, so the
+    // bands set off for them from this sample rather than the end of the interval
+    if (readTargets())
+        _until_update = 0;
+
+    for (int start = 0; start < numSamples;)
+    {
+        if (_until_update == 0)
+        {
+            updateSections();
+            _until_update = CONTROL_INTERVAL;
+        }
+
+        const int count = juce::jmin(numSamples - start, _until_update);
+        _sections.process(_z1.data(), _z2.data(), buffer.getArrayOfWritePointers(), numChannels, start, count);
+
+        start += count;
+        _until_update -= count;
+        _sections.advance(NUM_BANDS, count, _until_update);
+    }
+}
+
+FilterHealth::Repairs BreakpointBands::sanitiseState()
+{
+    // Bands at rest leave the state as reset() left it
+    if (! _sections.active)
+        return {};
+
+    FilterHealth::Repairs repairs;
+    for (int ch = 0; ch < _num_channels; ++ch)
+        repairs += FilterHealth::sanitise(_z1.data() + ch * CoefficientBank::MAX_SECTIONS,
+                                          _z2.data() + ch * CoefficientBank::MAX_SECTIONS, NUM_BANDS);
+
+    return repairs;
+}
+
+void BreakpointBands::updateSections()
+{
+    // One smoothing step for every band, moving or not: straight-line loops that vectorise.
+    // Within a hundredth of a dB (or cent) a band snaps to its target and stops moving.
+    std::array<float, NUM_BANDS> freqStep, gainStep, qStep;
+    for (int b = 0; b < NUM_BANDS; ++b)
+    {
+        freqStep[(size_t)b] = _smoothing * (_target_log_freq[(size_t)b] - _log_freq[(size_t)b]);
+        gainStep[(size_t)b] = _smoothing * (_target_gain_db[(size_t)b] - _gain_db[(size_t)b]);
+        qStep[(size_t)b] = _smoothing * (_target_log_q[(size_t)b] - _log_q[(size_t)b]);
+    }
+
+    bool anyActive = false, anyMoving = false;
+    for (int band = 0; band < NUM_BANDS; ++band)
+    {
+        const size_t b = (size_t)band;
+        const bool moving = freqStep[b] != 0.0f || gainStep[b] != 0.0f || qStep[b] != 0.0f;
+
+        if (moving)
+        {
+            const auto settle = [](float& value, float step, float target, float tolerance)
+            {
+                value = std::abs(target - value - step) < tolerance ? target : value + step;
+            };
+
+            settle(_log_freq[b], freqStep[b], _target_log_freq[b], 1.0e-4f);
+            settle(_gain_db[b], gainStep[b], _target_gain_db[b], 1.0e-2f);
+            settle(_log_q[b], qStep[b], _target_log_q[b], 1.0e-4f);
+
+            // Only bands that moved pay for the trig
+            _sections.targets.setSection(band, makeSection(_sample_rate, std::exp2(_log_freq[b]), std::exp2(_log_q[b]), _gain_db[b]));
+            anyMoving = true;
+        }
+
+        anyActive = anyActive || _gain_db[b] != 0.0f;
+    }
+
+    if (_sections.startInterval(NUM_BANDS, CONTROL_INTERVAL, anyMoving, anyActive))
+        reset();
+}
@@ -0,0 +1,120 @@
+/* Host-automatable breakpoints: a fixed pool of peaking bands over the drawn curve */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "CurveDesigner.h"
+#include "FilterHealth.h"
+#include "GlidingSections.h"
+
+/* One breakpoint's parameter values */
+struct BreakpointSettings
+{
+    float freq = 1000.0f; // Hz
+    float gain_db = 0.0f;
+    float q = 0.7071f;
+    bool enabled = false;
+
+    bool operator==(const BreakpointSettings& other) const
+    {
+        return freq == other.freq && gain_db == other.gain_db && q == other.q && enabled == other.enabled;
+    }
+    bool operator!=(const BreakpointSettings& other) const { return ! (*this == other); }
+};
+
+/* NUM_BANDS breakpoints, each a frequency, gain, Q and on/off parameter in the processor's
+   AudioProcessorValueTreeState, so hosts can automate them. Each is an RBJ peaking section
+   run after the drawn curve's cascade, at the host rate. FrequencyGraph draws them as
+   square handles apart from the curve's dots, and dragging one sets its parameters.
+
+   Unlike the drawn curve, whose sections are designed together on the design thread, each
+   band's coefficients follow from its own parameters alone, so they're worked out here on
+   the audio thread. process() reads the parameters through cached atomics at the start of
+   every block and splits the block wherever a parameter has moved: from that sample on,
+   the bands head for their new values. Frequency and Q are smoothed in log2, gain in dB
+   (a band that's switched off glides to 0 dB), all with one-pole steps every
+   CONTROL_INTERVAL samples, done for every band at once over contiguous arrays so they
+   vectorise. Only bands still moving get new coefficients, which the sections glide to
+   across the interval (see GlidingSections). */
+class BreakpointBands
+{
+public:
+    static constexpr int NUM_BANDS = 16;
+    static constexpr int CONTROL_INTERVAL = 32;
+    static constexpr double SMOOTHING_SECONDS = 0.02; // Time constant of the parameter smoothing
+
+    static constexpr float MIN_FREQ = 20.0f, MAX_FREQ = 20000.0f;
+    static constexpr float MAX_GAIN_DB = 24.0f;
+    static constexpr float MIN_Q = 0.1f, MAX_Q = 18.0f;
+
+    // Parameter IDs are "band<n>Freq", "band<n>Gain", "band<n>Q" and "band<n>On", n from 1.
+    // They're not the drawn curve's dots, which are as many as the user makes.
+    static juce::String getParameterId(int band, const char* field);
+    static void addParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout);
+
+    // Defaults spread the bands evenly (in log frequency) over the audio band, all off
+    static BreakpointSettings getDefault(int band);
+    static std::array<BreakpointSettings, NUM_BANDS> getDefaults();
+
+    // Message thread, once, before anything else: caches the parameters so nothing looks them up by name again
+    void attach(juce::AudioProcessorValueTreeState& parameters);
+
+    // Any thread
+    BreakpointSettings getSettings(int band) const;
+    // Message thread: sets the band's parameters, as a host would see the user do
+    void setSettings(int band, const BreakpointSettings& settings);
+    // Message thread: around a drag, so hosts record it as one edit
+    void beginChangeGesture(int band);
+    void endChangeGesture(int band);
+
+    // Any thread: the sections the bands would be with their parameters as they are now,
+    // padded with identity sections to NUM_BANDS, for drawing
+    static void design(const std::array<BreakpointSettings, NUM_BANDS>& settings, double sampleRate, CoefficientBank& bank);
+
+    // Not real-time safe. Bands start at their parameters' values rather than glide to them.
+    void prepare(double sampleRate, int numChannels);
+    void reset();
+
+    // Audio thread: every prepared channel in place
+    void process(juce::AudioBuffer<float>& buffer);
+
+    // Audio thread, once a block (see FilterHealth)
+    FilterHealth::Repairs sanitiseState();
+
+private:
+    struct Parameters
+    {
+        std::atomic<float>* freq = nullptr;
+        std::atomic<float>* gain = nullptr;
+        std::atomic<float>* q = nullptr;
+        std::atomic<float>* on = nullptr;
+        juce::RangedAudioParameter* freq_parameter = nullptr;
+        juce::RangedAudioParameter* gain_parameter = nullptr;
+        juce::RangedAudioParameter* q_parameter = nullptr;
+        juce::RangedAudioParameter* on_parameter = nullptr;
+    };
+
+    bool readTargets();       // True if any parameter moved since the last block
+    void updateSections();    // At the start of each control interval
+    void snapToTargets();
+
+    std::array<Parameters, NUM_BANDS> _parameters;
+
+    double _sample_rate = 44100.0;
+    int _num_channels = 0;
+    float _smoothing = 1.0f; // One-pole coefficient per control interval
+
+    // Smoothed values and where they're heading: log2 frequency, gain (dB), log2 Q
+    std::array<float, NUM_BANDS> _log_freq{}, _gain_db{}, _log_q{};
+    std::array<float, NUM_BANDS> _target_log_freq{}, _target_gain_db{}, _target_log_q{};
+    std::array<float, NUM_BANDS> _last_freq{}, _last_gain{}, _last_q{}, _last_on{}; // Raw parameter values last read
+
+    GlidingSections _sections; // One per band
+    int _until_update = 0;
+
+    // Transposed direct form II state, [channel * MAX_SECTIONS + band]
+    std::vector<float> _z1, _z2;
+};
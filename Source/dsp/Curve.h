@@ -0,0 +1,108 @@
+/* Breakpoint curve shared between the editor and the audio engine */
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/* Optional dynamics for a dot. Once the level of the dot's band goes over the threshold,
+   its gain comes down by (level - threshold) * (1 - 1 / ratio) dB, at most MAX_RANGE_DB. */
+struct DotDynamics
+{
+    static constexpr float MAX_RANGE_DB = 24.0f;
+
+    bool enabled = false;
+    float threshold_db = -24.0f; // Peak level of the band-filtered signal, dBFS
+    float ratio = 2.0f;
+    float attack_ms = 10.0f;
+    float release_ms = 150.0f;
+};
+
+struct CurvePoint
+{
+    float freq = 1000.0f; // Hz
+    float gain = 0.0f;    // dB
+    DotDynamics dynamics;
+};
+
+/* Fixed-capacity copy of the drawn curve. It never allocates, so it can be copied
+   around freely between the message thread and the DSP side. */
+struct CurveSnapshot
+{
+    static constexpr int MAX_POINTS = 256;
+
+    std::array<CurvePoint, MAX_POINTS> points{};
+    int num_points = 0;
+
+    // Build a snapshot from FrequencyGraph dots (frequency Hz, amplitude dB), and their
+    // dynamics if there's one for each dot (otherwise every dot is static).
+    // Curves with more dots than we can hold are decimated evenly, keeping both ends.
+    static CurveSnapshot fromDots(const std::vector<std::pair<float, float>>& dots,
+                                  const std::vector<DotDynamics>& dynamics = {})
+    {
+        CurveSnapshot snapshot;
+        const int count = static_cast<int>(dots.size());
+        const bool hasDynamics = dynamics.size() == dots.size();
+
+        snapshot.num_points = count <= MAX_POINTS ? count : MAX_POINTS;
+        for (int i = 0; i < snapshot.num_points; ++i)
+        {
+            auto src = count <= MAX_POINTS ? static_cast<std::size_t>(i)
+                                           : static_cast<std::size_t>((static_cast<long long>(i) * (count - 1)) / (MAX_POINTS - 1));
+            snapshot.points[i] = { dots[src].first, dots[src].second, hasDynamics ? dynamics[src] : DotDynamics{} };
+        }
+        return snapshot;
+    }
+
+    // Gain of the drawn curve: straight lines in log frequency between dots, flat past the ends
+    float gainAt(float freq) const
+    {
+        if (num_points == 0)
+            return 0.0f;
+        if (freq <= points[0].freq)
+            return points[0].gain;
+        if (freq >= points[num_points - 1].freq)
+            return points[num_points - 1].gain;
+
+        int hi = 1;
+        while (points[hi].freq < freq)
+            ++hi;
+
+        const auto& a = points[hi - 1];
+        const auto& b = points[hi];
+        if (b.freq <= a.freq)
+            return b.gain;
+
+        const float t = std::log(freq / a.freq) / std::log(b.freq / a.freq);
+        return a.gain + t * (b.gain - a.gain);
+    }
+
+    std::vector<std::pair<float, float>> toDots() const
+    {
+        std::vector<std::pair<float, float>> dots;
+        dots.reserve(num_points);
+        for (int i = 0; i < num_points; ++i)
+            dots.emplace_back(points[i].freq, points[i].gain);
+        return dots;
+    }
+
+    std::vector<DotDynamics> toDynamics() const
+    {
+        std::vector<DotDynamics> dynamics;
+        dynamics.reserve(num_points);
+        for (int i = 0; i < num_points; ++i)
+            dynamics.push_back(points[i].dynamics);
+        return dynamics;
+    }
+
+    int getNumDynamicPoints() const
+    {
+        int count = 0;
+        for (int i = 0; i < num_points; ++i)
+            count += points[i].dynamics.enabled ? 1 : 0;
+        return count;
+    }
+};
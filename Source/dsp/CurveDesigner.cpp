@@ -0,0 +1,134 @@
+#include <JuceHeader.h>
+#include <cmath>
+#include "CurveDesigner.h"
+
+namespace
+{
+    using SectionType = CurveDesigner::SectionShape::Type;
+
+    Biquad makeSection(const CurveDesigner::SectionShape& p, double sampleRate, double gainDb)
+    {
+        switch (p.type)
+        {
+            case SectionType::LowShelf:  return Biquad::lowShelf(sampleRate, p.freq, p.q, gainDb);
+            case SectionType::HighShelf: return Biquad::highShelf(sampleRate, p.freq, p.q, gainDb);
+            case SectionType::Peak:
+            default:                     return Biquad::peaking(sampleRate, p.freq, p.q, gainDb);
+        }
+    }
+
+    // Octave bandwidth to RBJ peaking Q
+    double bandwidthToQ(double octaves)
+    {
+        return 1.0 / (2.0 * std::sinh(std::log(2.0) / 2.0 * octaves));
+    }
+
+    // |H(e^jw)| in dB with the trig terms precomputed by the caller
+    double magnitudeDb(const Biquad& bq, double c1, double s1, double c2, double s2)
+    {
+        const double num_re = bq.b0 + bq.b1 * c1 + bq.b2 * c2;
+        const double num_im = -(bq.b1 * s1 + bq.b2 * s2);
+        const double den_re = 1.0 + bq.a1 * c1 + bq.a2 * c2;
+        const double den_im = -(bq.a1 * s1 + bq.a2 * s2);
+
+        const double num = num_re * num_re + num_im * num_im;
+        const double den = den_re * den_re + den_im * den_im;
+        return 10.0 * std::log10(std::max(num, 1e-30) / std::max(den, 1e-30));
+    }
+}
+
+CurveDesigner::SectionShape CurveDesigner::getSectionShape(const CurveSnapshot& curve, int i, double sampleRate)
+{
+    const int n = juce::jmin(curve.num_points, CoefficientBank::MAX_SECTIONS);
+    const double freq = juce::jlimit(1.0, sampleRate * 0.49, (double)curve.points[i].freq);
+    SectionShape p;
+
+    if (n > 1 && i == 0)
+    {
+        // Shelf corner halfway (in log frequency) to the next dot
+        p.type = SectionType::LowShelf;
+        p.freq = std::sqrt(freq * juce::jlimit(1.0, sampleRate * 0.49, (double)curve.points[1].freq));
+    }
+    else if (n > 1 && i == n - 1)
+    {
+        p.type = SectionType::HighShelf;
+        p.freq = std::sqrt(freq * juce::jlimit(1.0, sampleRate * 0.49, (double)curve.points[n - 2].freq));
+    }
+    else
+    {
+        // Peak spanning half-way to each neighbour
+        const double prev = (i > 0) ? (double)curve.points[i - 1].freq : freq * 0.5;
+        const double next = (i < n - 1) ? (double)curve.points[i + 1].freq : freq * 2.0;
+        const double octaves = juce::jlimit(0.05, 4.0, 0.5 * std::log2(juce::jmax(next, 1.0) / juce::jmax(prev, 1.0)));
+
+        p.type = SectionType::Peak;
+        p.freq = freq;
+        p.q = bandwidthToQ(octaves);
+    }
+
+    return p;
+}
+
+void CurveDesigner::design(const CurveSnapshot& curve, double sampleRate, CoefficientBank& bank)
+{
+    SectionGains gains;
+    design(curve, sampleRate, bank, gains);
+}
+
+void CurveDesigner::designWithGains(const CurveSnapshot& curve, double sampleRate, const SectionGains& gains, CoefficientBank& bank)
+{
+    const int n = juce::jmin(curve.num_points, CoefficientBank::MAX_SECTIONS);
+    bank.num_sections = (sampleRate > 0.0) ? n : 0;
+
+    for (int i = 0; i < bank.num_sections; ++i)
+        bank.setSection(i, makeSection(getSectionShape(curve, i, sampleRate), sampleRate, gains[i]));
+}
+
+void CurveDesigner::design(const CurveSnapshot& curve, double sampleRate, CoefficientBank& bank, SectionGains& gains)
+{
+    const int n = juce::jmin(curve.num_points, CoefficientBank::MAX_SECTIONS);
+    bank.num_sections = (sampleRate > 0.0) ? n : 0;
+
+    if (bank.num_sections == 0)
+        return;
+
+    std::array<SectionShape, CoefficientBank::MAX_SECTIONS> params;
+    std::array<double, CoefficientBank::MAX_SECTIONS> targets;
+    std::array<std::array<double, 4>, CoefficientBank::MAX_SECTIONS> trig; // cos w, sin w, cos 2w, sin 2w
+    std::array<Biquad, CoefficientBank::MAX_SECTIONS> sections;
+
+    for (int i = 0; i < n; ++i)
+    {
+        const double freq = juce::jlimit(1.0, sampleRate * 0.49, (double)curve.points[i].freq);
+        params[i] = getSectionShape(curve, i, sampleRate);
+
+        targets[i] = curve.points[i].gain;
+        gains[i] = targets[i];
+
+        const double w = juce::MathConstants<double>::twoPi * freq / sampleRate;
+        trig[i] = { std::cos(w), std::sin(w), std::cos(2.0 * w), std::sin(2.0 * w) };
+    }
+
+    // Neighbouring sections overlap, so nudge each section's gain until the
+    // cascade's response at every dot matches the drawn gain
+    for (int pass = 0; pass <= CORRECTION_PASSES; ++pass)
+    {
+        for (int i = 0; i < n; ++i)
+            sections[i] = makeSection(params[i], sampleRate, gains[i]);
+
+        if (pass == CORRECTION_PASSES)
+            break;
+
+        for (int j = 0; j < n; ++j)
+        {
+            double response = 0.0;
+            for (int i = 0; i < n; ++i)
+                response += magnitudeDb(sections[i], trig[j][0], trig[j][1], trig[j][2], trig[j][3]);
+
+            gains[j] = juce::jlimit(-MAX_SECTION_GAIN_DB, MAX_SECTION_GAIN_DB, gains[j] + (targets[j] - response));
+        }
+    }
+
+    for (int i = 0; i < n; ++i)
+        bank.setSection(i, sections[i]);
+}
@@ -0,0 +1,115 @@
+/* Turns a breakpoint curve into a cascade of minimum-phase biquad sections */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "Biquad.h"
+#include "Curve.h"
+
+/* Structure-of-arrays coefficient storage for the whole cascade.
+   Preallocated at full size, so publishing a new design never allocates. */
+struct CoefficientBank
+{
+    static constexpr int MAX_SECTIONS = CurveSnapshot::MAX_POINTS;
+
+    std::array<float, MAX_SECTIONS> b0{}, b1{}, b2{}, a1{}, a2{};
+    int num_sections = 0;
+
+    void setSection(int index, const Biquad& bq)
+    {
+        b0[index] = bq.b0;
+        b1[index] = bq.b1;
+        b2[index] = bq.b2;
+        a1[index] = bq.a1;
+        a2[index] = bq.a2;
+    }
+
+    Biquad getSection(int index) const
+    {
+        return { b0[index], b1[index], b2[index], a1[index], a2[index] };
+    }
+};
+
+/* What the audio thread needs for the curve's dynamic dots, one band each (see DynamicBands).
+   Arrays are padded to whole groups of bands with bands that detect nothing. */
+struct DynamicBandsDesign
+{
+    static constexpr int MAX_BANDS = CurveSnapshot::MAX_POINTS;
+
+    int num_bands = 0;
+    double sample_rate = 0.0; // The host's: dynamics run after any oversampling
+
+    // Sidechain filter per band: band pass around a peak's dot, low / high pass under / over a shelf's corner
+    CoefficientBank detector;
+
+    // Envelope follower: one-pole coefficients per sample, rising and falling
+    std::array<float, MAX_BANDS> attack{}, release{};
+
+    // Gain law: above threshold (linear), the section's RBJ amplitude is (level / threshold)^(-half_slope),
+    // i.e. (1 - 1 / ratio) dB of cut per dB over, and never below min_amplitude
+    std::array<float, MAX_BANDS> threshold{}, half_slope{}, min_amplitude{};
+
+    // The gain section's RBJ terms that don't depend on its gain: cos w0 and sin w0 / 2Q
+    std::array<float, MAX_BANDS> cos_w{}, alpha{};
+
+    // Bands that are shelves rather than peaks (the first and last dots'), or -1
+    int low_shelf_band = -1, high_shelf_band = -1;
+};
+
+/* A curve together with the cascade designed from it, handed to the audio thread as one unit */
+struct CurveDesign
+{
+    CurveSnapshot curve;
+    CoefficientBank bank;
+    DynamicBandsDesign dynamics;
+    double sample_rate = 0.0; // The rate the cascade runs at, oversampling included
+    std::int64_t submitted_ticks = 0; // When the edit behind this design was made, for latency metrics
+    int slot = 0; // The curve slot it was designed for
+};
+
+/* The cascade and dynamic bands of every curve slot, designed ahead of time so the audio
+   thread can switch slots by copying a bank, whatever the curves hold */
+struct SlotDesigns
+{
+    static constexpr int NUM_SLOTS = 8;
+
+    std::array<CoefficientBank, NUM_SLOTS> banks;
+    std::array<DynamicBandsDesign, NUM_SLOTS> dynamics;
+    std::array<std::uint32_t, NUM_SLOTS> versions{}; // Of the slots' curves each was designed from
+    double sample_rate = 0.0; // The cascade's, as CurveDesign
+};
+
+/* One section per breakpoint: the first and last dots become shelves, the others
+   peaking filters whose bandwidth spans to their neighbours. Section gains are then
+   corrected iteratively so the cascade passes through every dot.
+   Must not be called from the audio thread (it does a fair amount of trig). */
+class CurveDesigner
+{
+public:
+    static void design(const CurveSnapshot& curve, double sampleRate, CoefficientBank& bank);
+
+    // The same, also handing back the section gains (dB) the correction settled on
+    using SectionGains = std::array<double, CoefficientBank::MAX_SECTIONS>;
+    static void design(const CurveSnapshot& curve, double sampleRate, CoefficientBank& bank, SectionGains& gains);
+
+    // Sections shaped from the curve's dots but with the given gains, and no correction:
+    // a handful of trig calls per section, where design() is quadratic in the dots
+    static void designWithGains(const CurveSnapshot& curve, double sampleRate, const SectionGains& gains, CoefficientBank& bank);
+
+    // The filter each dot becomes, less its gain
+    struct SectionShape
+    {
+        enum class Type { LowShelf, Peak, HighShelf };
+
+        Type type = Type::Peak;
+        double freq = 1000.0;
+        double q = 0.7071;
+    };
+
+    static SectionShape getSectionShape(const CurveSnapshot& curve, int index, double sampleRate);
+
+private:
+    static constexpr int CORRECTION_PASSES = 4;
+    static constexpr double MAX_SECTION_GAIN_DB = 30.0;
+};
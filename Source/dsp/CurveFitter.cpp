@@ -0,0 +1,447 @@
+#include <JuceHeader.h>
+#include <algorithm>
+#include <cmath>
+#include "CurveFitter.h"
+
+namespace
+{
+    constexpr double DERIVATIVE_STEP = 1.0e-6; // In every parameter's own units (log10 Hz, dB, log10 Q)
+
+    // Octave bandwidth to RBJ peaking Q
+    double bandwidthToQ(double octaves)
+    {
+        return 1.0 / (2.0 * std::sinh(std::log(2.0) / 2.0 * octaves));
+    }
+
+    /* Solves (A + lambda diag(A)) x = b for the symmetric n x n matrix A by Cholesky.
+       Returns false if the damped matrix isn't positive definite. */
+    bool solveDamped(const std::vector<double>& a, const std::vector<double>& b, double lambda, int n,
+                     std::vector<double>& x, std::vector<double>& factor)
+    {
+        factor.assign((size_t)(n * n), 0.0);
+        x.resize((size_t)n);
+
+        for (int i = 0; i < n; ++i)
+        {
+            for (int j = 0; j <= i; ++j)
+            {
+                double sum = a[(size_t)(i * n + j)];
+                if (i == j)
+                    sum += lambda * sum + 1.0e-12;
+                for (int k = 0; k < j; ++k)
+                    sum -= factor[(size_t)(i * n + k)] * factor[(size_t)(j * n + k)];
+
+                if (i == j)
+                {
+                    if (sum <= 0.0)
+                        return false;
+                    factor[(size_t)(i * n + i)] = std::sqrt(sum);
+                }
+                else
+                {
+                    factor[(size_t)(i * n + j)] = sum / factor[(size_t)(j * n + j)];
+                }
+            }
+        }
+
+        for (int i = 0; i < n; ++i)
+        {
+            double sum = b[(size_t)i];
+            for (int k = 0; k < i; ++k)
+                sum -= factor[(size_t)(i * n + k)] * x[(size_t)k];
+            x[(size_t)i] = sum / factor[(size_t)(i * n + i)];
+        }
+        for (int i = n - 1; i >= 0; --i)
+        {
+            double sum = x[(size_t)i];
+            for (int k = i + 1; k < n; ++k)
+                sum -= factor[(size_t)(k * n + i)] * x[(size_t)k];
+            x[(size_t)i] = sum / factor[(size_t)(i * n + i)];
+        }
+        return true;
+    }
+}
+
+void CurveFitter::fit(const CurveSnapshot& curve, double sampleRate, float toleranceDb, CoefficientBank& bank)
+{
+    _num_iterations = 0;
+
+    if (sampleRate <= 0.0 || curve.num_points == 0)
+    {
+        bank.num_sections = 0;
+        _max_error_db = 0.0;
+        return;
+    }
+
+    if (sampleRate != _sample_rate)
+        setGrid(sampleRate);
+
+    for (int k = 0; k < GRID_SIZE; ++k)
+        _target[(size_t)k] = curve.gainAt((float)std::pow(10.0, _log_freqs[(size_t)k]));
+
+    const double tolerance = juce::jmax(0.01, (double)toleranceDb);
+
+    // Carry on from the last fit
+    for (auto& section : _sections)
+        clamp(section);
+    _cost = evaluate(_sections, _rows, _residual);
+    optimise(ITERATIONS_PER_ROUND, tolerance);
+
+    for (int round = 0; round < MAX_GROWTH_ROUNDS && maxError(_residual) > tolerance; ++round)
+    {
+        if (! addSections(tolerance))
+            break;
+
+        _cost = evaluate(_sections, _rows, _residual);
+        optimise(ITERATIONS_PER_ROUND, tolerance);
+    }
+
+    removeNegligible();
+    if (maxError(_residual) <= tolerance)
+        pruneWeakest(tolerance);
+
+    _max_error_db = maxError(_residual);
+
+    // Up to the last slot in use, with identity in the ones dropped sections left
+    bank.num_sections = 0;
+    for (const auto& section : _sections)
+        bank.num_sections = juce::jmax(bank.num_sections, section.slot + 1);
+
+    for (int s = 0; s < bank.num_sections; ++s)
+        bank.setSection(s, Biquad{});
+    for (const auto& section : _sections)
+        bank.setSection(section.slot, makeSection<float>(section));
+}
+
+template <typename T>
+BiquadCoefficients<T> CurveFitter::makeSection(const Section& section) const
+{
+    const double freq = std::pow(10.0, section.log_freq);
+    const double q = std::pow(10.0, section.log_q);
+
+    switch (section.type)
+    {
+        case Type::LowShelf:  return BiquadCoefficients<T>::lowShelf(_sample_rate, freq, q, section.gain_db);
+        case Type::HighShelf: return BiquadCoefficients<T>::highShelf(_sample_rate, freq, q, section.gain_db);
+        case Type::Peak:
+        default:              return BiquadCoefficients<T>::peaking(_sample_rate, freq, q, section.gain_db);
+    }
+}
+
+void CurveFitter::setGrid(double sampleRate)
+{
+    _sample_rate = sampleRate;
+
+    // Fit over the audible range; sections may sit a little beyond it
+    const double lo = std::log10(20.0);
+    const double hi = std::log10(juce::jmin(20000.0, 0.45 * sampleRate));
+    _min_log_freq = std::log10(10.0);
+    _max_log_freq = std::log10(0.45 * sampleRate);
+
+    for (int k = 0; k < GRID_SIZE; ++k)
+    {
+        _log_freqs[(size_t)k] = lo + (hi - lo) * k / (GRID_SIZE - 1);
+        const double w = juce::MathConstants<double>::twoPi * std::pow(10.0, _log_freqs[(size_t)k]) / sampleRate;
+        _trig[(size_t)k] = { std::cos(w), std::sin(w), std::cos(2.0 * w), std::sin(2.0 * w) };
+    }
+}
+
+void CurveFitter::clamp(Section& section) const
+{
+    section.log_freq = juce::jlimit(_min_log_freq, _max_log_freq, section.log_freq);
+    section.gain_db = juce::jlimit(-MAX_GAIN_DB, MAX_GAIN_DB, section.gain_db);
+
+    // Steep shelves overshoot, and very wide or narrow peaks are better done by something else
+    if (section.type == Type::Peak)
+        section.log_q = juce::jlimit(-1.0, 1.3, section.log_q);
+    else
+        section.log_q = juce::jlimit(std::log10(0.3), std::log10(1.5), section.log_q);
+}
+
+void CurveFitter::evaluateSection(const Section& section, double* row) const
+{
+    const auto bq = makeSection<double>(section);
+
+    for (int k = 0; k < GRID_SIZE; ++k)
+    {
+        const auto& t = _trig[(size_t)k];
+        const double num_re = bq.b0 + bq.b1 * t[0] + bq.b2 * t[2];
+        const double num_im = -(bq.b1 * t[1] + bq.b2 * t[3]);
+        const double den_re = 1.0 + bq.a1 * t[0] + bq.a2 * t[2];
+        const double den_im = -(bq.a1 * t[1] + bq.a2 * t[3]);
+
+        const double num = num_re * num_re + num_im * num_im;
+        const double den = den_re * den_re + den_im * den_im;
+        row[k] = 10.0 * std::log10(std::max(num, 1e-30) / std::max(den, 1e-30));
+    }
+}
+
+double CurveFitter::evaluate(const std::vector<Section>& sections, std::vector<double>& rows, std::vector<double>& residual) const
+{
+    rows.resize(sections.size() * GRID_SIZE);
+    residual.resize(GRID_SIZE);
+
+    for (int k = 0; k < GRID_SIZE; ++k)
+        residual[(size_t)k] = -_target[(size_t)k];
+
+    for (size_t s = 0; s < sections.size(); ++s)
+    {
+        double* row = rows.data() + s * GRID_SIZE;
+        evaluateSection(sections[s], row);
+        for (int k = 0; k < GRID_SIZE; ++k)
+            residual[(size_t)k] += row[k];
+    }
+
+    double cost = 0.0;
+    for (const auto r : residual)
+        cost += r * r;
+    return cost;
+}
+
+double CurveFitter::maxError(const std::vector<double>& residual) const
+{
+    double worst = 0.0;
+    for (const auto r : residual)
+        worst = juce::jmax(worst, std::abs(r));
+    return worst;
+}
+
+void CurveFitter::optimise(int maxIterations, double toleranceDb)
+{
+    const int numSections = (int)_sections.size();
+    const int n = numSections * PARAMS_PER_SECTION;
+    if (n == 0)
+        return;
+
+    _jacobian.resize((size_t)(n * GRID_SIZE));
+    _normal.resize((size_t)(n * n));
+    _gradient.resize((size_t)n);
+    _row.resize(GRID_SIZE);
+
+    double lambda = 1.0e-3;
+
+    for (int iteration = 0; iteration < maxIterations; ++iteration)
+    {
+        // One column per parameter, contiguous over the grid. Each parameter only
+        // moves its own section, so only that section's row needs evaluating.
+        for (int s = 0; s < numSections; ++s)
+        {
+            for (int p = 0; p < PARAMS_PER_SECTION; ++p)
+            {
+                auto moved = _sections[(size_t)s];
+                (p == 0 ? moved.log_freq : p == 1 ? moved.gain_db : moved.log_q) += DERIVATIVE_STEP;
+                evaluateSection(moved, _row.data());
+
+                const double* current = _rows.data() + s * GRID_SIZE;
+                double* column = _jacobian.data() + (s * PARAMS_PER_SECTION + p) * GRID_SIZE;
+                for (int k = 0; k < GRID_SIZE; ++k)
+                    column[k] = (_row[(size_t)k] - current[k]) / DERIVATIVE_STEP;
+            }
+        }
+
+        // Normal equations J^T J and -J^T r
+        for (int i = 0; i < n; ++i)
+        {
+            const double* ci = _jacobian.data() + i * GRID_SIZE;
+            for (int j = 0; j <= i; ++j)
+            {
+                const double* cj = _jacobian.data() + j * GRID_SIZE;
+                double sum = 0.0;
+                for (int k = 0; k < GRID_SIZE; ++k)
+                    sum += ci[k] * cj[k];
+                _normal[(size_t)(i * n + j)] = _normal[(size_t)(j * n + i)] = sum;
+            }
+
+            double g = 0.0;
+            for (int k = 0; k < GRID_SIZE; ++k)
+                g += ci[k] * _residual[(size_t)k];
+            _gradient[(size_t)i] = -g;
+        }
+
+        // Raise the damping until a step actually helps
+        double improvement = 0.0;
+        bool improved = false;
+        while (! improved && lambda < 1.0e10)
+        {
+            if (solveDamped(_normal, _gradient, lambda, n, _step, _factor))
+            {
+                _trial_sections = _sections;
+                for (int s = 0; s < numSections; ++s)
+                {
+                    auto& section = _trial_sections[(size_t)s];
+                    section.log_freq += _step[(size_t)(s * PARAMS_PER_SECTION)];
+                    section.gain_db += _step[(size_t)(s * PARAMS_PER_SECTION + 1)];
+                    section.log_q += _step[(size_t)(s * PARAMS_PER_SECTION + 2)];
+                    clamp(section);
+                }
+
+                const double trialCost = evaluate(_trial_sections, _trial_rows, _trial_residual);
+                if (trialCost < _cost)
+                {
+                    improvement = (_cost - trialCost) / juce::jmax(_cost, 1.0e-30);
+                    std::swap(_sections, _trial_sections);
+                    std::swap(_rows, _trial_rows);
+                    std::swap(_residual, _trial_residual);
+                    _cost = trialCost;
+                    lambda = juce::jmax(lambda * 0.3, 1.0e-9);
+                    improved = true;
+                    break;
+                }
+            }
+            lambda *= 10.0;
+        }
+
+        ++_num_iterations;
+
+        // Least squares isn't the goal: once inside the tolerance, stop polishing
+        if (! improved || improvement < 1.0e-4 || (improvement < 1.0e-2 && maxError(_residual) <= toleranceDb))
+            break;
+    }
+}
+
+bool CurveFitter::addSections(double toleranceDb)
+{
+    struct Lobe
+    {
+        int peak, lo, hi; // Grid index of the worst error, and of the half-error points either side
+        double error;
+    };
+    std::vector<Lobe> lobes;
+
+    // Runs of same-signed error that somewhere exceed the tolerance
+    for (int k = 0; k < GRID_SIZE;)
+    {
+        const bool positive = _residual[(size_t)k] > 0.0;
+        const int start = k;
+        int peak = k;
+        for (; k < GRID_SIZE && (_residual[(size_t)k] > 0.0) == positive; ++k)
+            if (std::abs(_residual[(size_t)k]) > std::abs(_residual[(size_t)peak]))
+                peak = k;
+
+        const double error = _residual[(size_t)peak];
+        if (std::abs(error) <= toleranceDb)
+            continue;
+
+        int lo = peak, hi = peak;
+        while (lo > start && std::abs(_residual[(size_t)(lo - 1)]) > 0.5 * std::abs(error))
+            --lo;
+        while (hi < k - 1 && std::abs(_residual[(size_t)(hi + 1)]) > 0.5 * std::abs(error))
+            ++hi;
+
+        lobes.push_back({ peak, lo, hi, error });
+    }
+
+    std::sort(lobes.begin(), lobes.end(), [](const Lobe& a, const Lobe& b) { return std::abs(a.error) > std::abs(b.error); });
+
+    const double gridStep = _log_freqs[1] - _log_freqs[0];
+    bool added = false;
+
+    for (const auto& lobe : lobes)
+    {
+        if ((int)_sections.size() >= MAX_SECTIONS)
+            break;
+
+        Section section;
+        section.gain_db = -lobe.error;
+
+        // Lobes running off either end of the grid are shelves, cornered where they halve
+        if (lobe.lo == 0)
+        {
+            section.type = Type::LowShelf;
+            section.log_freq = _log_freqs[(size_t)lobe.hi];
+            section.log_q = std::log10(juce::MathConstants<double>::sqrt2 * 0.5);
+        }
+        else if (lobe.hi == GRID_SIZE - 1)
+        {
+            section.type = Type::HighShelf;
+            section.log_freq = _log_freqs[(size_t)lobe.lo];
+            section.log_q = std::log10(juce::MathConstants<double>::sqrt2 * 0.5);
+        }
+        else
+        {
+            const double octaves = (_log_freqs[(size_t)lobe.hi] - _log_freqs[(size_t)lobe.lo] + gridStep) / std::log10(2.0);
+            section.type = Type::Peak;
+            section.log_freq = _log_freqs[(size_t)lobe.peak];
+            section.log_q = std::log10(bandwidthToQ(juce::jlimit(0.05, 6.0, octaves)));
+        }
+
+        clamp(section);
+        section.slot = findFreeSlot();
+        _sections.push_back(section);
+        added = true;
+    }
+
+    return added;
+}
+
+double CurveFitter::sectionEffect(size_t section) const
+{
+    const double* row = _rows.data() + section * GRID_SIZE;
+    double effect = 0.0;
+    for (int k = 0; k < GRID_SIZE; ++k)
+        effect = juce::jmax(effect, std::abs(row[k]));
+    return effect;
+}
+
+int CurveFitter::findFreeSlot() const
+{
+    // The lowest, so the bank doesn't grow while there are holes in it
+    std::array<bool, MAX_SECTIONS> used{};
+    for (const auto& section : _sections)
+        used[(size_t)section.slot] = true;
+
+    int slot = 0;
+    while (used[(size_t)slot])
+        ++slot;
+    return slot;
+}
+
+void CurveFitter::removeNegligible()
+{
+    size_t kept = 0;
+    for (size_t s = 0; s < _sections.size(); ++s)
+    {
+        if (sectionEffect(s) >= NEGLIGIBLE_DB)
+            _sections[kept++] = _sections[s];
+    }
+
+    if (kept < _sections.size())
+    {
+        _sections.resize(kept);
+        _cost = evaluate(_sections, _rows, _residual);
+    }
+}
+
+void CurveFitter::pruneWeakest(double toleranceDb)
+{
+    if (_sections.empty())
+        return;
+
+    // The section that does least
+    size_t weakest = 0;
+    double weakestEffect = 0.0;
+    for (size_t s = 0; s < _sections.size(); ++s)
+    {
+        const double effect = sectionEffect(s);
+        if (s == 0 || effect < weakestEffect)
+        {
+            weakest = s;
+            weakestEffect = effect;
+        }
+    }
+
+    // Anything much stronger than the tolerance won't be made up for by the others
+    if (weakestEffect > 4.0 * toleranceDb)
+        return;
+
+    _saved_sections = _sections;
+    _sections.erase(_sections.begin() + (std::ptrdiff_t)weakest);
+    _cost = evaluate(_sections, _rows, _residual);
+    optimise(ITERATIONS_PER_ROUND, toleranceDb);
+
+    if (maxError(_residual) > toleranceDb)
+    {
+        std::swap(_sections, _saved_sections);
+        _cost = evaluate(_sections, _rows, _residual);
+    }
+}
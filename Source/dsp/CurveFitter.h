@@ -0,0 +1,93 @@
+/* Fits a small cascade of parametric sections to a breakpoint curve */
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include "CurveDesigner.h"
+
+/* Auto-fit alternative to CurveDesigner, which spends a section on every dot. This one
+   looks for the fewest peaking and shelf sections whose combined response stays within
+   a dB tolerance of the curve, over GRID_SIZE log-spaced frequencies:
+
+    - frequency, gain and Q of every section are optimised together by Levenberg-Marquardt,
+      with derivatives by finite differences on double-precision coefficients
+    - while the worst error is over the tolerance, a section sized from each error lobe
+      that exceeds it is added, and the fit repeated
+    - once within the tolerance, it tries to do without the weakest section
+
+   The sections are kept between calls and each fit starts from the last one, so while a
+   dot is dragged every design is a few iterations on from an already good solution.
+   Each section keeps the bank slot it was added in, so EqEngine glides between like
+   sections: a dropped section leaves an identity section in its slot, which glides it
+   out, until a new section takes the slot over. Design thread only: allocates while the
+   section count grows. */
+class CurveFitter
+{
+public:
+    static constexpr int GRID_SIZE = 128;
+    static constexpr int MAX_SECTIONS = 32;
+
+    // Writes the fitted sections to bank
+    void fit(const CurveSnapshot& curve, double sampleRate, float toleranceDb, CoefficientBank& bank);
+
+    // Forget the warm start
+    void reset() { _sections.clear(); }
+
+    // About the last fit
+    int getNumSections() const { return (int)_sections.size(); }
+    float getMaxErrorDb() const { return (float)_max_error_db; }
+    int getNumIterations() const { return _num_iterations; }
+
+private:
+    enum class Type { LowShelf, Peak, HighShelf };
+
+    struct Section
+    {
+        Type type = Type::Peak;
+        double log_freq = 3.0; // log10 Hz
+        double gain_db = 0.0;
+        double log_q = -0.15;  // log10 Q
+        int slot = 0;          // In the bank
+    };
+
+    static constexpr int PARAMS_PER_SECTION = 3;
+    static constexpr int MAX_GROWTH_ROUNDS = 8;
+    static constexpr int ITERATIONS_PER_ROUND = 12;
+    static constexpr double MAX_GAIN_DB = 30.0;
+    static constexpr double NEGLIGIBLE_DB = 0.01; // Sections with less effect than this are dropped outright
+
+    template <typename T>
+    BiquadCoefficients<T> makeSection(const Section& section) const;
+
+    void setGrid(double sampleRate);
+    void clamp(Section& section) const;
+    void evaluateSection(const Section& section, double* row) const;
+    double evaluate(const std::vector<Section>& sections, std::vector<double>& rows, std::vector<double>& residual) const;
+    double maxError(const std::vector<double>& residual) const;
+    double sectionEffect(size_t section) const; // Largest |dB| the section contributes anywhere on the grid
+    int findFreeSlot() const;
+
+    void optimise(int maxIterations, double toleranceDb);
+    bool addSections(double toleranceDb);
+    void removeNegligible();
+    void pruneWeakest(double toleranceDb);
+
+    std::vector<Section> _sections;
+    std::vector<double> _rows, _residual; // [section * GRID_SIZE + k] dB response of each section; model - target
+    double _cost = 0.0;                   // Sum of squared residuals
+
+    // Grid
+    double _sample_rate = 0.0;
+    double _min_log_freq = 0.0, _max_log_freq = 0.0;
+    std::array<double, GRID_SIZE> _log_freqs{}, _target{};
+    std::array<std::array<double, 4>, GRID_SIZE> _trig{}; // cos w, sin w, cos 2w, sin 2w
+
+    // Levenberg-Marquardt scratch
+    std::vector<Section> _trial_sections, _saved_sections;
+    std::vector<double> _trial_rows, _trial_residual;
+    std::vector<double> _jacobian, _normal, _gradient, _step, _factor, _row;
+
+    double _max_error_db = 0.0;
+    int _num_iterations = 0;
+};
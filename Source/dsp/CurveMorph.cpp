@@ -0,0 +1,115 @@
+#include <JuceHeader.h>
+#include <algorithm>
+#include "CurveMorph.h"
+
+namespace
+{
+    constexpr float MIN_SPACING = 1.122f; // A sixth of an octave
+}
+
+float MorphSettings::getPosition(const juce::MidiMessage& message) const
+{
+    switch (source)
+    {
+        case Source::Controller:
+            if (message.isController() && message.getControllerNumber() == controller)
+                return (float)message.getControllerValue() / 127.0f;
+            break;
+
+        case Source::Notes:
+            if (message.isNoteOn() && high_note > low_note)
+                return juce::jlimit(0.0f, 1.0f, (float)(message.getNoteNumber() - low_note) / (float)(high_note - low_note));
+            break;
+
+        case Source::Off:
+        default:
+            break;
+    }
+
+    return -1.0f;
+}
+
+CurveSnapshot CurveMorph::blend(const CurveSnapshot& from, const CurveSnapshot& to, float t)
+{
+    // Both curves' dots, in order. Where a dot of one comes close after a dot of the other,
+    // only the first is kept: the designer makes a poor job of sections that close.
+    std::vector<std::pair<float, int>> all; // Frequency, and which curve
+    all.reserve((size_t)(from.num_points + to.num_points));
+    for (int i = 0; i < from.num_points; ++i)
+        all.emplace_back(from.points[i].freq, 0);
+    for (int i = 0; i < to.num_points; ++i)
+        all.emplace_back(to.points[i].freq, 1);
+
+    std::sort(all.begin(), all.end());
+
+    std::vector<float> freqs;
+    freqs.reserve(all.size());
+    int previousCurve = -1;
+    for (const auto& [freq, curve] : all)
+    {
+        if (! freqs.empty() && freq < freqs.back() * MIN_SPACING && (curve != previousCurve || freq == freqs.back()))
+            continue;
+
+        freqs.push_back(freq);
+        previousCurve = curve;
+    }
+
+    std::vector<std::pair<float, float>> dots;
+    dots.reserve(freqs.size());
+    for (const auto freq : freqs)
+        dots.emplace_back(freq, (1.0f - t) * from.gainAt(freq) + t * to.gainAt(freq));
+
+    // More than fit get decimated, the same way for every t
+    return CurveSnapshot::fromDots(dots);
+}
+
+void CurveMorph::design(const CurveSnapshot& from, const CurveSnapshot& to, double sampleRate, MorphTable& table)
+{
+    table.sample_rate = sampleRate;
+    table.num_sections = 0;
+
+    if (from.num_points < 2 || to.num_points < 2)
+        return;
+
+    // Only the ends get the full design. Every step shares their dots' frequencies, so in
+    // between only the gains differ, and those are interpolated from the ends' corrected ones.
+    constexpr int last = MorphTable::NUM_STEPS - 1;
+    const auto dots = blend(from, to, 0.0f);
+    CurveDesigner::SectionGains fromGains, toGains, gains;
+    CurveDesigner::design(dots, sampleRate, table.steps[0], fromGains);
+    CurveDesigner::design(blend(from, to, 1.0f), sampleRate, table.steps[(size_t)last], toGains);
+
+    table.num_sections = table.steps[0].num_sections;
+    for (int s = 1; s < last; ++s)
+    {
+        const double t = (double)s / (double)last;
+        for (int i = 0; i < table.num_sections; ++i)
+            gains[(size_t)i] = (1.0 - t) * fromGains[(size_t)i] + t * toGains[(size_t)i];
+
+        CurveDesigner::designWithGains(dots, sampleRate, gains, table.steps[(size_t)s]);
+    }
+}
+
+void CurveMorph::interpolate(const MorphTable& table, float position, CoefficientBank& bank)
+{
+    const float x = juce::jlimit(0.0f, 1.0f, position) * (float)(MorphTable::NUM_STEPS - 1);
+    const int lower = juce::jmin((int)x, MorphTable::NUM_STEPS - 2);
+    const float t = x - (float)lower;
+
+    const auto& a = table.steps[(size_t)lower];
+    const auto& b = table.steps[(size_t)lower + 1];
+    const int n = table.num_sections;
+
+    const auto mix = [&](float* out, const float* from, const float* to)
+    {
+        juce::FloatVectorOperations::copyWithMultiply(out, from, 1.0f - t, n);
+        juce::FloatVectorOperations::addWithMultiply(out, to, t, n);
+    };
+
+    mix(bank.b0.data(), a.b0.data(), b.b0.data());
+    mix(bank.b1.data(), a.b1.data(), b.b1.data());
+    mix(bank.b2.data(), a.b2.data(), b.b2.data());
+    mix(bank.a1.data(), a.a1.data(), b.a1.data());
+    mix(bank.a2.data(), a.a2.data(), b.a2.data());
+    bank.num_sections = n;
+}
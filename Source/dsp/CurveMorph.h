@@ -0,0 +1,53 @@
+/* MIDI-driven morphing of the cascade from the drawn curve to a stored one */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "CurveDesigner.h"
+
+/* What moves the morph. Positions run from 0 (the drawn curve) to 1 (the stored one). */
+struct MorphSettings
+{
+    enum class Source { Off, Controller, Notes };
+
+    Source source = Source::Off;
+    int controller = 1; // CC number for Source::Controller, on any channel (1 is the mod wheel)
+    int low_note = 36;  // Notes keytrack: note-ons from low_note (position 0) to high_note (1)
+    int high_note = 96;
+
+    // The position a MIDI message moves the morph to, or -1 if it doesn't
+    float getPosition(const juce::MidiMessage& message) const;
+};
+
+/* Cascades at NUM_STEPS evenly spaced positions between two curves. Every step has the
+   same dots (both curves' together, with gains blended between them), so section i is
+   the same filter shape throughout and only its gain moves. Only the two ends are fully
+   designed; the steps between take section gains (dB) interpolated from the ends'
+   corrected ones. The cascade's response in dB is close to linear in the section gains,
+   so that lands about where the correction passes would, for two designs' work
+   instead of NUM_STEPS. The audio thread interpolates the
+   coefficients of neighbouring steps rather than design anything. Interpolating
+   (a1, a2) stays inside the convex stability triangle, so every position in between
+   is stable. */
+struct MorphTable
+{
+    static constexpr int NUM_STEPS = 17;
+
+    std::array<CoefficientBank, NUM_STEPS> steps;
+    int num_sections = 0; // 0 for no morph
+    double sample_rate = 0.0;
+};
+
+class CurveMorph
+{
+public:
+    // Design thread: not real-time safe (two designs). Dynamics stay with the drawn curve.
+    static void design(const CurveSnapshot& from, const CurveSnapshot& to, double sampleRate, MorphTable& table);
+
+    // Audio thread: the cascade at a position from 0 to 1, between the two nearest steps
+    static void interpolate(const MorphTable& table, float position, CoefficientBank& bank);
+
+    // The dots every step is designed from, gains blended a fraction t of the way
+    static CurveSnapshot blend(const CurveSnapshot& from, const CurveSnapshot& to, float t);
+};
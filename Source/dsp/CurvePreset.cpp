@@ -0,0 +1,520 @@
+#include <JuceHeader.h>
+#include "CurvePreset.h"
+
+namespace
+{
+    void addDotElements(juce::XmlElement& parent, const CurveSnapshot& curve)
+    {
+        for (int i = 0; i < curve.num_points; ++i)
+        {
+            auto* dot = parent.createNewChildElement("Dot");
+            dot->setAttribute("freq", curve.points[i].freq);
+            dot->setAttribute("gain", curve.points[i].gain);
+
+            const auto& dynamics = curve.points[i].dynamics;
+            if (dynamics.enabled)
+            {
+                dot->setAttribute("threshold", dynamics.threshold_db);
+                dot->setAttribute("ratio", dynamics.ratio);
+                dot->setAttribute("attack", dynamics.attack_ms);
+                dot->setAttribute("release", dynamics.release_ms);
+            }
+        }
+    }
+
+    CurveSnapshot readDotElements(const juce::XmlElement& parent)
+    {
+        std::vector<std::pair<float, float>> dots;
+        std::vector<DotDynamics> dynamics;
+        for (auto* dot : parent.getChildWithTagNameIterator("Dot"))
+        {
+            dots.emplace_back((float)dot->getDoubleAttribute("freq"), (float)dot->getDoubleAttribute("gain"));
+
+            DotDynamics d;
+            d.enabled = dot->hasAttribute("threshold");
+            d.threshold_db = (float)dot->getDoubleAttribute("threshold", d.threshold_db);
+            d.ratio = (float)dot->getDoubleAttribute("ratio", d.ratio);
+            d.attack_ms = (float)dot->getDoubleAttribute("attack", d.attack_ms);
+            d.release_ms = (float)dot->getDoubleAttribute("release", d.release_ms);
+            dynamics.push_back(d);
+        }
+
+        return CurveSnapshot::fromDots(dots, dynamics);
+    }
+
+    bool isValidCurve(const CurveSnapshot& curve)
+    {
+        for (int i = 0; i < curve.num_points; ++i)
+        {
+            const auto& point = curve.points[i];
+            if (! CurvePreset::isValidDot(point, i > 0 ? curve.points[i - 1].freq : CurvePreset::MIN_FREQ)
+                || (point.dynamics.enabled && ! CurvePreset::isValidDynamics(point.dynamics)))
+                return false;
+        }
+        return true;
+    }
+}
+
+bool CurvePreset::isValidDot(const CurvePoint& point, float previousFreq)
+{
+    return point.freq >= previousFreq && point.freq >= MIN_FREQ && point.freq <= MAX_FREQ && std::isfinite(point.gain);
+}
+
+bool CurvePreset::isValidBreakpoint(const BreakpointSettings& settings)
+{
+    return settings.freq >= BreakpointBands::MIN_FREQ && settings.freq <= BreakpointBands::MAX_FREQ
+        && std::abs(settings.gain_db) <= BreakpointBands::MAX_GAIN_DB
+        && settings.q >= BreakpointBands::MIN_Q && settings.q <= BreakpointBands::MAX_Q;
+}
+
+bool CurvePreset::isValidDynamics(const DotDynamics& dynamics)
+{
+    // Written so NaNs fail every comparison
+    return dynamics.ratio > 1.0f && dynamics.ratio <= MAX_RATIO
+        && dynamics.threshold_db >= MIN_THRESHOLD_DB && dynamics.threshold_db <= 0.0f
+        && dynamics.attack_ms > 0.0f && dynamics.attack_ms <= MAX_TIME_MS
+        && dynamics.release_ms > 0.0f && dynamics.release_ms <= MAX_TIME_MS;
+}
+
+std::unique_ptr<juce::XmlElement> CurvePreset::toXml() const
+{
+    auto xml = std::make_unique<juce::XmlElement>("CurvePreset");
+    xml->setAttribute("version", VERSION);
+    xml->setAttribute("linearPhase", linear_phase);
+    xml->setAttribute("firLength", fir_length);
+    xml->setAttribute("autoFit", auto_fit);
+    xml->setAttribute("fitTolerance", fit_tolerance_db);
+    xml->setAttribute("oversampling", oversampling);
+    xml->setAttribute("currentSlot", current_slot);
+    addDotElements(*xml, curve);
+
+    for (int band = 0; band < BreakpointBands::NUM_BANDS; ++band)
+    {
+        const auto& settings = breakpoints[(size_t)band];
+        if (settings == BreakpointBands::getDefault(band))
+            continue;
+
+        auto* breakpoint = xml->createNewChildElement("Breakpoint");
+        breakpoint->setAttribute("band", band);
+        breakpoint->setAttribute("freq", settings.freq);
+        breakpoint->setAttribute("gain", settings.gain_db);
+        breakpoint->setAttribute("q", settings.q);
+        breakpoint->setAttribute("enabled", settings.enabled);
+    }
+
+    if (morph.source != MorphSettings::Source::Off || morph_target.num_points > 0)
+    {
+        auto* element = xml->createNewChildElement("Morph");
+        element->setAttribute("source", (int)morph.source);
+        element->setAttribute("controller", morph.controller);
+        element->setAttribute("lowNote", morph.low_note);
+        element->setAttribute("highNote", morph.high_note);
+
+        for (int i = 0; i < morph_target.num_points; ++i)
+        {
+            auto* dot = element->createNewChildElement("Dot");
+            dot->setAttribute("freq", morph_target.points[i].freq);
+            dot->setAttribute("gain", morph_target.points[i].gain);
+        }
+    }
+
+    for (int slot = 0; slot < SlotDesigns::NUM_SLOTS; ++slot)
+    {
+        if (slot == current_slot || slots[(size_t)slot].num_points == 0)
+            continue;
+
+        auto* element = xml->createNewChildElement("Slot");
+        element->setAttribute("index", slot);
+        addDotElements(*element, slots[(size_t)slot]);
+    }
+
+    return xml;
+}
+
+juce::Result CurvePreset::fromXml(const juce::XmlElement& xml)
+{
+    if (! xml.hasTagName("CurvePreset"))
+        return juce::Result::fail("isn't a curve preset");
+
+    if (xml.getIntAttribute("version", VERSION) > VERSION)
+        return juce::Result::fail("was saved by a newer version");
+
+    CurvePreset preset;
+    preset.curve = readDotElements(xml);
+    if (preset.curve.num_points < 2)
+        return juce::Result::fail("has fewer than two dots");
+    if (! isValidCurve(preset.curve))
+        return juce::Result::fail("has a damaged dot");
+
+    preset.linear_phase = xml.getBoolAttribute("linearPhase", preset.linear_phase);
+    preset.fir_length = xml.getIntAttribute("firLength", preset.fir_length);
+    preset.auto_fit = xml.getBoolAttribute("autoFit", preset.auto_fit);
+    preset.fit_tolerance_db = (float)xml.getDoubleAttribute("fitTolerance", preset.fit_tolerance_db);
+    preset.oversampling = xml.getIntAttribute("oversampling", preset.oversampling);
+    preset.current_slot = xml.getIntAttribute("currentSlot", preset.current_slot);
+    if (! juce::isPositiveAndBelow(preset.current_slot, SlotDesigns::NUM_SLOTS))
+        return juce::Result::fail("has a slot that doesn't exist");
+
+    for (auto* breakpoint : xml.getChildWithTagNameIterator("Breakpoint"))
+    {
+        const int band = breakpoint->getIntAttribute("band", -1);
+        if (! juce::isPositiveAndBelow(band, BreakpointBands::NUM_BANDS))
+            return juce::Result::fail("has a breakpoint that doesn't exist");
+
+        auto& settings = preset.breakpoints[(size_t)band];
+        settings.freq = (float)breakpoint->getDoubleAttribute("freq", settings.freq);
+        settings.gain_db = (float)breakpoint->getDoubleAttribute("gain", settings.gain_db);
+        settings.q = (float)breakpoint->getDoubleAttribute("q", settings.q);
+        settings.enabled = breakpoint->getBoolAttribute("enabled", settings.enabled);
+        if (! isValidBreakpoint(settings))
+            return juce::Result::fail("has a damaged breakpoint");
+    }
+
+    if (auto* element = xml.getChildByName("Morph"))
+    {
+        preset.morph.source = (MorphSettings::Source)juce::jlimit(0, 2, element->getIntAttribute("source"));
+        preset.morph.controller = juce::jlimit(0, 127, element->getIntAttribute("controller", preset.morph.controller));
+        preset.morph.low_note = juce::jlimit(0, 127, element->getIntAttribute("lowNote", preset.morph.low_note));
+        preset.morph.high_note = juce::jlimit(0, 127, element->getIntAttribute("highNote", preset.morph.high_note));
+
+        std::vector<std::pair<float, float>> targetDots;
+        for (auto* dot : element->getChildWithTagNameIterator("Dot"))
+            targetDots.emplace_back((float)dot->getDoubleAttribute("freq"), (float)dot->getDoubleAttribute("gain"));
+        preset.morph_target = CurveSnapshot::fromDots(targetDots);
+        if (! isValidCurve(preset.morph_target))
+            return juce::Result::fail("has a damaged morph dot");
+    }
+
+    for (auto* element : xml.getChildWithTagNameIterator("Slot"))
+    {
+        const int slot = element->getIntAttribute("index", -1);
+        if (! juce::isPositiveAndBelow(slot, SlotDesigns::NUM_SLOTS))
+            return juce::Result::fail("has a slot that doesn't exist");
+
+        auto& slotCurve = preset.slots[(size_t)slot];
+        slotCurve = readDotElements(*element);
+        if (slotCurve.num_points < 2)
+            return juce::Result::fail("has a slot with fewer than two dots");
+        if (! isValidCurve(slotCurve))
+            return juce::Result::fail("has a damaged slot");
+    }
+
+    *this = preset;
+    return juce::Result::ok();
+}
+
+namespace
+{
+    constexpr auto MAGIC = CurvePreset::chunkId("EQps");
+    constexpr auto SETTINGS = CurvePreset::chunkId("SETS");
+    constexpr auto DOTS = CurvePreset::chunkId("DOTS");
+    constexpr auto DYNAMICS = CurvePreset::chunkId("DYNS");
+    constexpr auto BREAKPOINTS = CurvePreset::chunkId("BRKP");
+    constexpr auto MORPH = CurvePreset::chunkId("MRPH");
+    constexpr auto SLOT = CurvePreset::chunkId("SLOT");
+
+    constexpr int SETTINGS_SIZE = 12;
+    constexpr int DOT_SIZE = 8;
+    constexpr int DYNAMICS_SIZE = 20;
+    constexpr int BREAKPOINT_SIZE = 20;
+    constexpr int MORPH_HEADER_SIZE = 4;
+    constexpr int SLOT_HEADER_SIZE = 8;
+
+    void writeDots(juce::OutputStream& out, const CurveSnapshot& curve)
+    {
+        for (int i = 0; i < curve.num_points; ++i)
+        {
+            out.writeFloat(curve.points[i].freq);
+            out.writeFloat(curve.points[i].gain);
+        }
+    }
+
+    // Only the dynamic dots, so a plain curve costs nothing
+    void writeDynamics(juce::OutputStream& out, const CurveSnapshot& curve)
+    {
+        for (int i = 0; i < curve.num_points; ++i)
+        {
+            const auto& dynamics = curve.points[i].dynamics;
+            if (! dynamics.enabled)
+                continue;
+
+            out.writeInt(i);
+            out.writeFloat(dynamics.threshold_db);
+            out.writeFloat(dynamics.ratio);
+            out.writeFloat(dynamics.attack_ms);
+            out.writeFloat(dynamics.release_ms);
+        }
+    }
+
+    // False for a dot that can't be right (see CurvePreset::isValidDot())
+    bool readDots(juce::InputStream& in, int count, CurveSnapshot& curve)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            auto& point = curve.points[i];
+            point.freq = in.readFloat();
+            point.gain = in.readFloat();
+
+            if (! CurvePreset::isValidDot(point, i > 0 ? curve.points[i - 1].freq : CurvePreset::MIN_FREQ))
+                return false;
+        }
+
+        curve.num_points = count;
+        return true;
+    }
+
+    // Refers to dots by index, so they have to have been read first. False for a dot that's
+    // missing, or dynamics that can't be run (see CurvePreset::isValidDynamics()).
+    bool readDynamics(juce::InputStream& in, int count, CurveSnapshot& curve)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            const int index = in.readInt();
+            if (index < 0 || index >= curve.num_points)
+                return false;
+
+            auto& dynamics = curve.points[index].dynamics;
+            dynamics.enabled = true;
+            dynamics.threshold_db = in.readFloat();
+            dynamics.ratio = in.readFloat();
+            dynamics.attack_ms = in.readFloat();
+            dynamics.release_ms = in.readFloat();
+
+            if (! CurvePreset::isValidDynamics(dynamics))
+                return false;
+        }
+
+        return true;
+    }
+}
+
+void CurvePreset::writeChunkHeader(juce::OutputStream& out, juce::uint32 id, int size)
+{
+    out.writeInt((int)id);
+    out.writeInt(size);
+}
+
+void CurvePreset::writeBinary(juce::OutputStream& out) const
+{
+    out.writeInt((int)MAGIC);
+    out.writeInt(VERSION);
+
+    writeChunkHeader(out, SETTINGS, SETTINGS_SIZE);
+    out.writeByte(linear_phase ? 1 : 0);
+    out.writeByte(auto_fit ? 1 : 0);
+    out.writeByte((char)oversampling);
+    out.writeByte((char)current_slot);
+    out.writeInt(fir_length);
+    out.writeFloat(fit_tolerance_db);
+
+    writeChunkHeader(out, DOTS, curve.num_points * DOT_SIZE);
+    writeDots(out, curve);
+
+    const int numDynamic = curve.getNumDynamicPoints();
+    if (numDynamic > 0)
+    {
+        writeChunkHeader(out, DYNAMICS, numDynamic * DYNAMICS_SIZE);
+        writeDynamics(out, curve);
+    }
+
+    // Likewise only the breakpoints that aren't at their defaults
+    int numChanged = 0;
+    for (int band = 0; band < BreakpointBands::NUM_BANDS; ++band)
+        numChanged += breakpoints[(size_t)band] != BreakpointBands::getDefault(band) ? 1 : 0;
+
+    if (numChanged > 0)
+    {
+        writeChunkHeader(out, BREAKPOINTS, numChanged * BREAKPOINT_SIZE);
+        for (int band = 0; band < BreakpointBands::NUM_BANDS; ++band)
+        {
+            const auto& settings = breakpoints[(size_t)band];
+            if (settings == BreakpointBands::getDefault(band))
+                continue;
+
+            out.writeInt(band);
+            out.writeFloat(settings.freq);
+            out.writeFloat(settings.gain_db);
+            out.writeFloat(settings.q);
+            out.writeInt(settings.enabled ? 1 : 0);
+        }
+    }
+
+    if (morph.source != MorphSettings::Source::Off || morph_target.num_points > 0)
+    {
+        writeChunkHeader(out, MORPH, MORPH_HEADER_SIZE + morph_target.num_points * DOT_SIZE);
+        out.writeByte((char)morph.source);
+        out.writeByte((char)morph.controller);
+        out.writeByte((char)morph.low_note);
+        out.writeByte((char)morph.high_note);
+        writeDots(out, morph_target);
+    }
+
+    for (int slot = 0; slot < SlotDesigns::NUM_SLOTS; ++slot)
+    {
+        const auto& slotCurve = slots[(size_t)slot];
+        if (slot == current_slot || slotCurve.num_points == 0)
+            continue;
+
+        writeChunkHeader(out, SLOT, SLOT_HEADER_SIZE + slotCurve.num_points * DOT_SIZE
+                                    + slotCurve.getNumDynamicPoints() * DYNAMICS_SIZE);
+        out.writeInt(slot);
+        out.writeInt(slotCurve.num_points);
+        writeDots(out, slotCurve);
+        writeDynamics(out, slotCurve);
+    }
+}
+
+bool CurvePreset::isBinary(const void* data, size_t size)
+{
+    return size >= 8 && juce::ByteOrder::littleEndianInt(data) == MAGIC;
+}
+
+juce::Result CurvePreset::readBinary(const void* data, size_t size)
+{
+    if (! isBinary(data, size))
+        return juce::Result::fail("isn't a curve preset");
+
+    juce::MemoryInputStream in(data, size, false);
+    in.skipNextBytes(4);
+    if (in.readInt() > VERSION)
+        return juce::Result::fail("was saved by a newer version");
+
+    // Copied from rather than constructed here: a preset is far too big for the stack
+    static const CurvePreset defaults;
+    *this = defaults;
+
+    auto& preset = *this;
+    bool hasDots = false;
+
+    while (! in.isExhausted())
+    {
+        if (in.getNumBytesRemaining() < 8)
+            return juce::Result::fail("is truncated");
+
+        const auto id = (juce::uint32)in.readInt();
+        const int chunkSize = in.readInt();
+        if (chunkSize < 0 || chunkSize > in.getNumBytesRemaining())
+            return juce::Result::fail("is truncated");
+
+        const auto end = in.getPosition() + chunkSize;
+        const auto fits = [&](int bytes) { return end - in.getPosition() >= bytes; };
+
+        if (id == SETTINGS)
+        {
+            if (fits(4))
+            {
+                preset.linear_phase = in.readByte() != 0;
+                preset.auto_fit = in.readByte() != 0;
+                preset.oversampling = (juce::uint8)in.readByte();
+                preset.current_slot = (juce::uint8)in.readByte();
+            }
+            if (fits(4))
+                preset.fir_length = in.readInt();
+            if (fits(4))
+                preset.fit_tolerance_db = in.readFloat();
+        }
+        else if (id == DOTS)
+        {
+            const int count = chunkSize / DOT_SIZE;
+            if (count > CurveSnapshot::MAX_POINTS)
+                return juce::Result::fail("has too many dots");
+
+            if (! readDots(in, count, preset.curve))
+                return juce::Result::fail("has a damaged dot");
+
+            hasDots = true;
+        }
+        else if (id == DYNAMICS)
+        {
+            // DOTS has to have come first
+            if (! readDynamics(in, chunkSize / DYNAMICS_SIZE, preset.curve))
+                return juce::Result::fail("has damaged dynamics");
+        }
+        else if (id == BREAKPOINTS)
+        {
+            for (int i = 0; i < chunkSize / BREAKPOINT_SIZE; ++i)
+            {
+                const int band = in.readInt();
+                if (! juce::isPositiveAndBelow(band, BreakpointBands::NUM_BANDS))
+                    return juce::Result::fail("has a breakpoint that doesn't exist");
+
+                auto& settings = preset.breakpoints[(size_t)band];
+                settings.freq = in.readFloat();
+                settings.gain_db = in.readFloat();
+                settings.q = in.readFloat();
+                settings.enabled = in.readInt() != 0;
+
+                if (! isValidBreakpoint(settings))
+                    return juce::Result::fail("has a damaged breakpoint");
+            }
+        }
+        else if (id == MORPH)
+        {
+            if (fits(MORPH_HEADER_SIZE))
+            {
+                preset.morph.source = (MorphSettings::Source)juce::jlimit(0, 2, (int)(juce::uint8)in.readByte());
+                preset.morph.controller = juce::jlimit(0, 127, (int)(juce::uint8)in.readByte());
+                preset.morph.low_note = juce::jlimit(0, 127, (int)(juce::uint8)in.readByte());
+                preset.morph.high_note = juce::jlimit(0, 127, (int)(juce::uint8)in.readByte());
+            }
+
+            const int count = juce::jmax(0, chunkSize - MORPH_HEADER_SIZE) / DOT_SIZE;
+            if (count > CurveSnapshot::MAX_POINTS)
+                return juce::Result::fail("has too many morph dots");
+
+            if (! readDots(in, count, preset.morph_target))
+                return juce::Result::fail("has a damaged morph dot");
+        }
+        else if (id == SLOT)
+        {
+            if (! fits(SLOT_HEADER_SIZE))
+                return juce::Result::fail("has a damaged slot");
+
+            const int slot = in.readInt();
+            const int count = in.readInt();
+            if (! juce::isPositiveAndBelow(slot, SlotDesigns::NUM_SLOTS))
+                return juce::Result::fail("has a slot that doesn't exist");
+            if (count < 2 || count > CurveSnapshot::MAX_POINTS || ! fits(count * DOT_SIZE))
+                return juce::Result::fail("has a damaged slot");
+
+            auto& slotCurve = preset.slots[(size_t)slot];
+            if (! readDots(in, count, slotCurve))
+                return juce::Result::fail("has a damaged slot");
+            if (! readDynamics(in, (int)(end - in.getPosition()) / DYNAMICS_SIZE, slotCurve))
+                return juce::Result::fail("has damaged dynamics");
+        }
+
+        in.setPosition(end);
+    }
+
+    if (! hasDots || preset.curve.num_points < 2)
+        return juce::Result::fail("has fewer than two dots");
+    if (! juce::isPositiveAndBelow(preset.current_slot, SlotDesigns::NUM_SLOTS))
+        return juce::Result::fail("has a slot that doesn't exist");
+
+    return juce::Result::ok();
+}
+
+juce::Result CurvePreset::saveTo(const juce::File& file) const
+{
+    if (! toXml()->writeTo(file))
+        return juce::Result::fail("Couldn't write " + file.getFullPathName());
+
+    return juce::Result::ok();
+}
+
+juce::Result CurvePreset::loadFrom(const juce::File& file)
+{
+    if (! file.existsAsFile())
+        return juce::Result::fail(file.getFullPathName() + " doesn't exist");
+
+    const auto xml = juce::parseXML(file);
+    if (xml == nullptr)
+        return juce::Result::fail(file.getFullPathName() + " isn't a curve preset");
+
+    const auto result = fromXml(*xml);
+    if (result.failed())
+        return juce::Result::fail(file.getFullPathName() + " " + result.getErrorMessage());
+
+    return result;
+}
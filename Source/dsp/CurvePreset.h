@@ -0,0 +1,108 @@
+/* The drawn curve and processing settings, saved to and loaded from a file */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BreakpointBands.h"
+#include "Curve.h"
+#include "CurveDesigner.h"
+#include "CurveMorph.h"
+
+/* Everything that decides what the EQ does to the audio, so the offline renderer
+   processes a file exactly as the plugin would. Stored as a small XML document:
+
+       <CurvePreset version="1" linearPhase="0" firLength="16384" autoFit="0"
+                    fitTolerance="0.5" oversampling="1" currentSlot="0">
+         <Dot freq="10" gain="0"/>
+         <Dot freq="250" gain="3" threshold="-24" ratio="2" attack="10" release="150"/>
+         ...
+         <Breakpoint band="3" freq="120" gain="-4" q="2" enabled="1"/>
+         <Morph source="1" controller="1" lowNote="36" highNote="96">
+           <Dot freq="10" gain="-6"/>
+           ...
+         </Morph>
+         <Slot index="1">
+           <Dot freq="10" gain="2"/>
+           ...
+         </Slot>
+       </CurvePreset>
+
+   Dots with a threshold are dynamic (see DotDynamics). Only breakpoints changed from
+   their defaults are written (see BreakpointBands), and the morph (see CurveMorph) only
+   if it has a source or a target curve. The top-level dots are the current slot's curve,
+   and every other slot that has dots is a Slot holding its own. Attributes missing from
+   a file keep their defaults, so older presets still load.
+
+   The plugin state holds the same thing in a compact binary form, which loads with no
+   parsing and no allocation. Little-endian throughout: a header, then chunks.
+
+       "EQps" version:u32
+       "SETS" size:u32  linearPhase:u8 autoFit:u8 oversampling:u8 currentSlot:u8 firLength:u32 fitTolerance:f32
+       "DOTS" size:u32  (freq:f32 gain:f32) per dot
+       "DYNS" size:u32  (dot:u32 threshold:f32 ratio:f32 attack:f32 release:f32) per dynamic dot
+       "BRKP" size:u32  (band:u32 freq:f32 gain:f32 q:f32 enabled:u32) per changed breakpoint
+       "MRPH" size:u32  source:u8 controller:u8 lowNote:u8 highNote:u8 (freq:f32 gain:f32) per target dot
+       "SLOT" size:u32  slot:u32 numDots:u32 (freq:f32 gain:f32) per dot, then DYNS's fields per dynamic dot
+
+   readBinary() skips chunks it doesn't know, so the state can carry others alongside
+   (see writeChunkHeader()), and fields missing from the end of a chunk keep their
+   defaults. Either form is rejected whole if any dot is out of the graph's range or
+   out of order, any dynamics can't be run (see isValidDynamics()), or any breakpoint
+   is outside its parameters' ranges. */
+struct CurvePreset
+{
+    static constexpr int VERSION = 1;
+
+    CurveSnapshot curve;
+    bool linear_phase = false;
+    int fir_length = 16384;
+    bool auto_fit = false;
+    float fit_tolerance_db = 0.5f;
+    int oversampling = 1;
+    std::array<BreakpointSettings, BreakpointBands::NUM_BANDS> breakpoints = BreakpointBands::getDefaults();
+    CurveSnapshot morph_target; // No dots for none
+    MorphSettings morph;
+
+    // The curve slots the host sees as programs. curve is the current slot's; the others
+    // are kept here (the current one's entry is ignored), and a slot with no dots is flat.
+    std::array<CurveSnapshot, SlotDesigns::NUM_SLOTS> slots;
+    int current_slot = 0;
+
+    juce::Result saveTo(const juce::File& file) const;
+    // On failure the preset is left as it was
+    juce::Result loadFrom(const juce::File& file);
+
+    // The same document in memory
+    std::unique_ptr<juce::XmlElement> toXml() const;
+    juce::Result fromXml(const juce::XmlElement& xml);
+
+    // Binary form. readBinary() starts from the defaults and reads straight into this
+    // preset, with nothing preset-sized on the stack, and doesn't allocate unless it fails.
+    // On failure the preset is left part read: read into a scratch preset and copy it over.
+    void writeBinary(juce::OutputStream& out) const;
+    juce::Result readBinary(const void* data, size_t size);
+    static bool isBinary(const void* data, size_t size); // Starts with the binary header
+
+    static constexpr juce::uint32 chunkId(const char (&id)[5])
+    {
+        return (juce::uint32)(juce::uint8)id[0] | (juce::uint32)(juce::uint8)id[1] << 8
+             | (juce::uint32)(juce::uint8)id[2] << 16 | (juce::uint32)(juce::uint8)id[3] << 24;
+    }
+
+    // For chunks of the caller's own after writeBinary()
+    static void writeChunkHeader(juce::OutputStream& out, juce::uint32 id, int size);
+
+    // What a loaded dot may be: inside the graph's range, at or above the one before it
+    static constexpr float MIN_FREQ = 10.0f, MAX_FREQ = 20000.0f;
+    static bool isValidDot(const CurvePoint& point, float previousFreq);
+
+    // Settings the graph's menu could have made, give or take: a ratio over 1, a threshold
+    // below 0 dBFS, and attack and release times DynamicBands can follow
+    static bool isValidDynamics(const DotDynamics& dynamics);
+    static constexpr float MIN_THRESHOLD_DB = -120.0f;
+    static constexpr float MAX_RATIO = 100.0f;
+    static constexpr float MAX_TIME_MS = 10000.0f;
+
+    // Inside the ranges of the bands' parameters
+    static bool isValidBreakpoint(const BreakpointSettings& settings);
+};
@@ -0,0 +1,101 @@
+#include <JuceHeader.h>
+#include "DesignWorker.h"
+
+DesignWorker::DesignWorker(DesignFunction designFunction)
+    : _design(std::move(designFunction))
+{
+    _thread->add(this);
+}
+
+DesignWorker::~DesignWorker()
+{
+    _thread->remove(this);
+}
+
+void DesignWorker::submit(DesignRequest request)
+{
+    request.submitted_ticks = juce::Time::getHighResolutionTicks();
+    request.sequence = _num_submitted.load(std::memory_order_relaxed) + 1;
+
+    _requests.getWriteBuffer() = request;
+    _requests.publish();
+    _num_submitted.store(request.sequence, std::memory_order_relaxed);
+
+    _pending.store(true, std::memory_order_release);
+    _thread->wake();
+}
+
+bool DesignWorker::designPending()
+{
+    if (! _pending.exchange(false, std::memory_order_acq_rel))
+        return false;
+
+    // Only the newest request is left in the buffer, however many were submitted
+    if (! _requests.update())
+        return false;
+
+    const auto start = juce::Time::getHighResolutionTicks();
+    _design(_requests.getReadBuffer());
+    const auto end = juce::Time::getHighResolutionTicks();
+
+    _last_design_ms.store((float)(juce::Time::highResolutionTicksToSeconds(end - start) * 1000.0), std::memory_order_relaxed);
+    _num_designed.fetch_add(1, std::memory_order_relaxed);
+    _num_settled.store(_requests.getReadBuffer().sequence, std::memory_order_release);
+
+    // Designs per second over a window of about a second
+    if (_rate_window_count == 0)
+        _rate_window_start = start;
+
+    ++_rate_window_count;
+    const auto elapsed = juce::Time::highResolutionTicksToSeconds(end - _rate_window_start);
+    if (elapsed >= 1.0)
+    {
+        _designs_per_second.store((float)(_rate_window_count / elapsed), std::memory_order_relaxed);
+        _rate_window_count = 0;
+    }
+
+    return true;
+}
+
+//==========================
+
+DesignThread::DesignThread()
+    : juce::Thread("Filter design")
+{
+    startThread(juce::Thread::Priority::normal);
+}
+
+DesignThread::~DesignThread()
+{
+    stopThread(2000);
+}
+
+void DesignThread::add(DesignWorker* worker)
+{
+    const juce::ScopedLock lock(_lock);
+    _workers.push_back(worker);
+}
+
+void DesignThread::remove(DesignWorker* worker)
+{
+    const juce::ScopedLock lock(_lock);
+    _workers.erase(std::remove(_workers.begin(), _workers.end(), worker), _workers.end());
+}
+
+void DesignThread::run()
+{
+    while (! threadShouldExit())
+    {
+        wait(-1);
+
+        bool designedAny = true;
+        while (designedAny && ! threadShouldExit())
+        {
+            const juce::ScopedLock lock(_lock);
+
+            designedAny = false;
+            for (auto* worker : _workers)
+                designedAny = worker->designPending() || designedAny;
+        }
+    }
+}
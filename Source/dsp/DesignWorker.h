@@ -0,0 +1,111 @@
+/* Background filter design with coalescing of rapid curve edits */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <vector>
+#include "Curve.h"
+#include "TripleBuffer.h"
+
+/* Everything needed to design the filters for one curve edit */
+struct DesignRequest
+{
+    CurveSnapshot curve;
+    double sample_rate = 0.0; // Base rate; the cascade runs oversampling times faster
+    int oversampling = 1;
+    int fir_length = 0;
+    bool linear_phase = false;
+    bool auto_fit = false;
+    float fit_tolerance_db = 0.5f;
+    CurveSnapshot morph_target; // Curve to morph towards, or no dots for no morph
+    int slot = 0; // The curve slot the curve is, and that slot's version when it was submitted
+    juce::uint32 slot_version = 0;
+    juce::int64 submitted_ticks = 0; // juce::Time::getHighResolutionTicks() at submit()
+    juce::uint32 sequence = 0;       // Set by submit(): requests submitted so far, this one included
+};
+
+/* Snapshot of how the design pipeline is keeping up */
+struct DesignMetrics
+{
+    float designs_per_second = 0.0f;
+    float design_ms = 0.0f;      // Wall time of the last design
+    float latency_ms = 0.0f;     // Edit to processBlock picking up its design, last one
+    float max_latency_ms = 0.0f; // ... and worst since prepareToPlay
+    juce::uint32 num_submitted = 0;
+    juce::uint32 num_designed = 0; // The rest were coalesced away
+    bool idle = false; // The newest submitted request has been designed
+};
+
+class DesignThread;
+
+/* Per-processor front end to the design thread. submit() only overwrites the latest
+   request in a triple buffer, so a burst of mouseDrag edits collapses into whatever is
+   newest when the design thread gets round to this instance; the ones in between are
+   never designed. The design itself is done by the owner's callback, on the design thread.
+
+   A single design thread is shared by every instance in the process, so a session with
+   hundreds of instances doesn't get hundreds of mostly idle threads. */
+class DesignWorker
+{
+public:
+    using DesignFunction = std::function<void(const DesignRequest&)>;
+
+    explicit DesignWorker(DesignFunction designFunction);
+    // Waits for a design in progress for this instance to finish
+    ~DesignWorker();
+
+    // Message thread only
+    void submit(DesignRequest request);
+
+    // Designs actually run per second, over the last second or so
+    float getDesignsPerSecond() const { return _designs_per_second.load(std::memory_order_relaxed); }
+    // Wall time of the last design
+    float getLastDesignMs() const { return _last_design_ms.load(std::memory_order_relaxed); }
+    juce::uint32 getNumSubmitted() const { return _num_submitted.load(std::memory_order_relaxed); }
+    juce::uint32 getNumDesigned() const { return _num_designed.load(std::memory_order_relaxed); }
+    // True once the newest request has been designed. Unlike comparing the two counts above,
+    // this doesn't count requests that were coalesced into a newer one as outstanding.
+    bool isIdle() const { return _num_settled.load(std::memory_order_acquire) == _num_submitted.load(std::memory_order_relaxed); }
+
+private:
+    friend class DesignThread;
+
+    // Design thread: runs the newest pending request, if any. Returns true if it did.
+    bool designPending();
+
+    DesignFunction _design;
+    TripleBuffer<DesignRequest> _requests;
+    std::atomic<bool> _pending{ false };
+
+    std::atomic<juce::uint32> _num_submitted{ 0 };
+    std::atomic<juce::uint32> _num_designed{ 0 };
+    std::atomic<juce::uint32> _num_settled{ 0 }; // Sequence number of the last request designed
+    std::atomic<float> _designs_per_second{ 0.0f };
+    std::atomic<float> _last_design_ms{ 0.0f };
+    juce::int64 _rate_window_start = 0; // Design thread only
+    juce::uint32 _rate_window_count = 0;
+
+    juce::SharedResourcePointer<DesignThread> _thread;
+
+    JUCE_DECLARE_NON_COPYABLE(DesignWorker)
+};
+
+/* The process-wide design thread behind every DesignWorker. Services instances
+   round-robin, one design each per pass, until nothing is pending. */
+class DesignThread : private juce::Thread
+{
+public:
+    DesignThread();
+    ~DesignThread() override;
+
+    void add(DesignWorker* worker);
+    void remove(DesignWorker* worker);
+    void wake() { notify(); }
+
+private:
+    void run() override;
+
+    juce::CriticalSection _lock; // Held while designing, so remove() waits for a design in progress
+    std::vector<DesignWorker*> _workers;
+};
@@ -0,0 +1,293 @@
+#include <JuceHeader.h>
+#include <cmath>
+#include "DynamicBands.h"
+#include "BiquadCascade.h"
+
+namespace
+{
+    // Sections the cascade kernel runs for a bank of this many
+    int getNumPaddedSections(int numSections)
+    {
+        const int lanes = BiquadCascade::getNumLanes();
+        return juce::jmin(CoefficientBank::MAX_SECTIONS, (numSections + lanes - 1) / lanes * lanes);
+    }
+
+    // RBJ shelves from their precomputed terms, as in Biquad.cpp
+    Biquad makeShelf(bool high, float cosw, float alpha, float A)
+    {
+        const float beta = 2.0f * std::sqrt(A) * alpha;
+        const float sign = high ? -1.0f : 1.0f;
+        const float a0 = (A + 1.0f) + sign * (A - 1.0f) * cosw + beta;
+
+        return { A * ((A + 1.0f) - sign * (A - 1.0f) * cosw + beta) / a0,
+                 sign * 2.0f * A * ((A - 1.0f) - sign * (A + 1.0f) * cosw) / a0,
+                 A * ((A + 1.0f) - sign * (A - 1.0f) * cosw - beta) / a0,
+                 -sign * 2.0f * ((A - 1.0f) + sign * (A + 1.0f) * cosw) / a0,
+                 ((A + 1.0f) + sign * (A - 1.0f) * cosw - beta) / a0 };
+    }
+}
+
+void DynamicBands::design(const CurveSnapshot& curve, double sampleRate, DynamicBandsDesign& design)
+{
+    using Type = CurveDesigner::SectionShape::Type;
+
+    design.num_bands = 0;
+    design.sample_rate = sampleRate;
+    design.low_shelf_band = design.high_shelf_band = -1;
+
+    for (int i = 0; i < curve.num_points && sampleRate > 0.0; ++i)
+    {
+        const auto& dynamics = curve.points[i].dynamics;
+        if (! dynamics.enabled)
+            continue;
+
+        const int b = design.num_bands++;
+        const auto shape = CurveDesigner::getSectionShape(curve, i, sampleRate);
+
+        // The sidechain hears what the gain section would act on
+        switch (shape.type)
+        {
+            case Type::LowShelf:
+                design.detector.setSection(b, Biquad::lowPass(sampleRate, shape.freq, 0.7071));
+                design.low_shelf_band = b;
+                break;
+            case Type::HighShelf:
+                design.detector.setSection(b, Biquad::highPass(sampleRate, shape.freq, 0.7071));
+                design.high_shelf_band = b;
+                break;
+            case Type::Peak:
+            default:
+                design.detector.setSection(b, Biquad::bandPass(sampleRate, shape.freq, shape.q));
+                break;
+        }
+
+        const double w0 = juce::MathConstants<double>::twoPi * juce::jlimit(1.0, sampleRate * 0.49, shape.freq) / sampleRate;
+        design.cos_w[b] = (float)std::cos(w0);
+        design.alpha[b] = (float)(std::sin(w0) / (2.0 * shape.q));
+
+        design.attack[b] = (float)(1.0 - std::exp(-1000.0 / (juce::jmax(0.1, (double)dynamics.attack_ms) * sampleRate)));
+        design.release[b] = (float)(1.0 - std::exp(-1000.0 / (juce::jmax(1.0, (double)dynamics.release_ms) * sampleRate)));
+        design.threshold[b] = juce::Decibels::decibelsToGain(dynamics.threshold_db, -200.0f);
+        design.half_slope[b] = 0.5f * (1.0f - 1.0f / juce::jmax(1.0f, dynamics.ratio));
+        design.min_amplitude[b] = std::pow(10.0f, -DotDynamics::MAX_RANGE_DB / 40.0f);
+    }
+
+    // Pad to whole groups with bands that hear nothing and stay at 0 dB
+    const int padded = juce::jmin(DynamicBandsDesign::MAX_BANDS, (design.num_bands + GROUP - 1) / GROUP * GROUP);
+    for (int b = design.num_bands; b < padded; ++b)
+    {
+        design.detector.setSection(b, { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f });
+        design.attack[b] = design.release[b] = 0.0f;
+        design.threshold[b] = 1.0f;
+        design.half_slope[b] = 0.0f;
+        design.min_amplitude[b] = 1.0f;
+        design.cos_w[b] = design.alpha[b] = 0.0f;
+    }
+
+    design.detector.num_sections = design.num_bands;
+}
+
+void DynamicBands::prepare(double sampleRate, int numChannels)
+{
+    _sample_rate = sampleRate;
+    _num_channels = numChannels;
+
+    _z1.assign(static_cast<size_t>(numChannels) * CoefficientBank::MAX_SECTIONS, 0.0f);
+    _z2.assign(static_cast<size_t>(numChannels) * CoefficientBank::MAX_SECTIONS, 0.0f);
+
+    _design = {};
+    reset();
+}
+
+void DynamicBands::reset()
+{
+    _detector_z1.fill(0.0f);
+    _detector_z2.fill(0.0f);
+    _envelope.fill(0.0f);
+    std::fill(_z1.begin(), _z1.end(), 0.0f);
+    std::fill(_z2.begin(), _z2.end(), 0.0f);
+
+    _gains.clear();
+    _until_update = 0;
+}
+
+void DynamicBands::setDesign(const DynamicBandsDesign& design)
+{
+    const int previous = _design.num_bands;
+    _design = design;
+
+    // Bands that just came into use or went out of it start over from 0 dB and silence
+    for (int b = juce::jmin(previous, design.num_bands); b < juce::jmax(previous, design.num_bands); ++b)
+    {
+        _detector_z1[(size_t)b] = _detector_z2[(size_t)b] = _envelope[(size_t)b] = 0.0f;
+        _gains.sections.setSection(b, Biquad{});
+        _gains.targets.setSection(b, Biquad{});
+
+        for (int ch = 0; ch < _num_channels; ++ch)
+        {
+            _z1[(size_t)(ch * CoefficientBank::MAX_SECTIONS + b)] = 0.0f;
+            _z2[(size_t)(ch * CoefficientBank::MAX_SECTIONS + b)] = 0.0f;
+        }
+    }
+
+    // Start a new interval from wherever the gains have got to, towards the new shapes
+    _until_update = 0;
+}
+
+void DynamicBands::process(juce::AudioBuffer<float>& buffer)
+{
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = juce::jmin(buffer.getNumChannels(), _num_channels);
+    if (_design.num_bands == 0 || numChannels == 0)
+        return;
+
+    const int numSections = getNumPaddedSections(_design.num_bands);
+
+    for (int start = 0; start < numSamples;)
+    {
+        if (_until_update == 0)
+        {
+            updateGains();
+            _until_update = CONTROL_INTERVAL;
+        }
+
+        const int count = juce::jmin(_until_update, numSamples - start);
+
+        // The sidechain is this stage's input, all channels alike
+        juce::FloatVectorOperations::copy(_sidechain.data(), buffer.getReadPointer(0, start), count);
+        for (int ch = 1; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::add(_sidechain.data(), buffer.getReadPointer(ch, start), count);
+        if (numChannels > 1)
+            juce::FloatVectorOperations::multiply(_sidechain.data(), 1.0f / (float)numChannels, count);
+
+        detect(_sidechain.data(), count);
+        _gains.process(_z1.data(), _z2.data(), buffer.getArrayOfWritePointers(), numChannels, start, count);
+
+        start += count;
+        _until_update -= count;
+        _gains.advance(numSections, count, _until_update);
+    }
+}
+
+FilterHealth::Repairs DynamicBands::sanitiseState()
+{
+    if (_design.num_bands == 0)
+        return {};
+
+    // The same counts process() and detect() run
+    const int numSections = getNumPaddedSections(_design.num_bands);
+    const int numBands = juce::jmin(DynamicBandsDesign::MAX_BANDS, (_design.num_bands + GROUP - 1) / GROUP * GROUP);
+
+    auto repairs = FilterHealth::sanitise(_detector_z1.data(), _detector_z2.data(), numBands);
+    repairs += FilterHealth::sanitise(_envelope.data(), numBands);
+    for (int ch = 0; ch < _num_channels; ++ch)
+        repairs += FilterHealth::sanitise(_z1.data() + ch * CoefficientBank::MAX_SECTIONS,
+                                          _z2.data() + ch * CoefficientBank::MAX_SECTIONS, numSections);
+
+    return repairs;
+}
+
+void DynamicBands::detect(const float* sidechain, int numSamples)
+{
+    // Bands in groups of GROUP, each group's coefficients and state held in locals for the
+    // whole run. The inner loop has no dependencies between lanes, so it becomes a few
+    // vector steps whose filter recursions overlap instead of waiting on one another.
+    const int numBands = juce::jmin(DynamicBandsDesign::MAX_BANDS, (_design.num_bands + GROUP - 1) / GROUP * GROUP);
+    const auto& bank = _design.detector;
+
+    for (int base = 0; base < numBands; base += GROUP)
+    {
+        float b0[GROUP], b1[GROUP], b2[GROUP], a1[GROUP], a2[GROUP];
+        float attack[GROUP], release[GROUP], z1[GROUP], z2[GROUP], envelope[GROUP];
+
+        for (int k = 0; k < GROUP; ++k)
+        {
+            const size_t b = (size_t)(base + k);
+            b0[k] = bank.b0[b]; b1[k] = bank.b1[b]; b2[k] = bank.b2[b];
+            a1[k] = bank.a1[b]; a2[k] = bank.a2[b];
+            attack[k] = _design.attack[b];
+            release[k] = _design.release[b];
+            z1[k] = _detector_z1[b];
+            z2[k] = _detector_z2[b];
+            envelope[k] = _envelope[b];
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float x = sidechain[i];
+            for (int k = 0; k < GROUP; ++k)
+            {
+                const float y = b0[k] * x + z1[k];
+                z1[k] = (b1[k] * x + z2[k]) - a1[k] * y;
+                z2[k] = b2[k] * x - a2[k] * y;
+
+                const float level = std::abs(y);
+                const float coefficient = level > envelope[k] ? attack[k] : release[k];
+                envelope[k] += coefficient * (level - envelope[k]);
+            }
+        }
+
+        for (int k = 0; k < GROUP; ++k)
+        {
+            const size_t b = (size_t)(base + k);
+            _detector_z1[b] = z1[k];
+            _detector_z2[b] = z2[k];
+            _envelope[b] = envelope[k];
+        }
+    }
+}
+
+void DynamicBands::updateGains()
+{
+    const int numBands = _design.num_bands;
+    const int numSections = getNumPaddedSections(numBands);
+
+    // RBJ amplitude of each band's gain section from its envelope. Bands under the
+    // threshold (the usual case) skip the pow.
+    std::array<float, DynamicBandsDesign::MAX_BANDS> amplitude;
+    bool anyActive = false;
+    for (int b = 0; b < numBands; ++b)
+    {
+        const float over = _envelope[(size_t)b] / _design.threshold[(size_t)b];
+        amplitude[(size_t)b] = 1.0f;
+        if (over > 1.0f)
+        {
+            amplitude[(size_t)b] = juce::jmax(_design.min_amplitude[(size_t)b], std::pow(over, -_design.half_slope[(size_t)b]));
+            anyActive = true;
+        }
+    }
+
+    // Every band as a peak first, which vectorises, then redo the shelves
+    for (int b = 0; b < numBands; ++b)
+    {
+        const float A = amplitude[(size_t)b];
+        const float alpha = _design.alpha[(size_t)b];
+        const float a0 = 1.0f / (1.0f + alpha / A);
+
+        _gains.targets.b0[(size_t)b] = (1.0f + alpha * A) * a0;
+        _gains.targets.b1[(size_t)b] = -2.0f * _design.cos_w[(size_t)b] * a0;
+        _gains.targets.b2[(size_t)b] = (1.0f - alpha * A) * a0;
+        _gains.targets.a1[(size_t)b] = _gains.targets.b1[(size_t)b];
+        _gains.targets.a2[(size_t)b] = (1.0f - alpha / A) * a0;
+    }
+
+    for (const auto& [band, high] : { std::pair<int, bool>{ _design.low_shelf_band, false }, { _design.high_shelf_band, true } })
+        if (band >= 0)
+            _gains.targets.setSection(band, makeShelf(high, _design.cos_w[(size_t)band], _design.alpha[(size_t)band], amplitude[(size_t)band]));
+
+    // The kernel runs whole lane groups; the sections past the bands stay identity
+    for (int s = numBands; s < numSections; ++s)
+    {
+        _gains.targets.setSection(s, Biquad{});
+        _gains.sections.setSection(s, Biquad{});
+    }
+
+    _gains.sections.num_sections = _gains.step.num_sections = _gains.targets.num_sections = numBands;
+
+    // Envelopes move every interval, so the gains always glide
+    if (_gains.startInterval(numSections, CONTROL_INTERVAL, true, anyActive))
+    {
+        std::fill(_z1.begin(), _z1.end(), 0.0f);
+        std::fill(_z2.begin(), _z2.end(), 0.0f);
+    }
+}
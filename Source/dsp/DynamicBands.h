@@ -0,0 +1,67 @@
+/* Dynamic EQ: a gain section per dynamic dot, driven by its band's level */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+#include "CurveDesigner.h"
+#include "FilterHealth.h"
+#include "GlidingSections.h"
+
+/* Runs after the static EQ, on whatever it outputs. Each dynamic dot gets a band: a
+   sidechain filter on the channels' average, a peak envelope follower, and a gain
+   section shaped like the dot's own (see CurveDesigner::getSectionShape()) that sits at
+   0 dB until the envelope goes over the threshold.
+
+   The filters and followers run GROUP bands at a time across vector lanes, so each sample
+   costs a few vector steps per group rather than a pass per band. GROUP spans several
+   vectors (16 measured best for both SSE and AVX builds), which keeps enough independent
+   filter recursions in flight to hide their latency. Gains are only worked out
+   every CONTROL_INTERVAL samples, from the envelopes at that point, and the gain
+   sections glide to them over the interval (see GlidingSections), so while every band
+   is under its threshold they're skipped. */
+class DynamicBands
+{
+public:
+    static constexpr int CONTROL_INTERVAL = 32;
+    static constexpr int GROUP = 16;
+
+    // Design thread: bands for the curve's dynamic dots. Not real-time safe (trig).
+    static void design(const CurveSnapshot& curve, double sampleRate, DynamicBandsDesign& design);
+
+    // Not real-time safe
+    void prepare(double sampleRate, int numChannels);
+    void reset();
+
+    // Audio thread: switch to a new design. Bands keep their filter state and envelopes
+    // by index, and their gains glide from where they were.
+    void setDesign(const DynamicBandsDesign& design);
+
+    // Audio thread: every prepared channel in place
+    void process(juce::AudioBuffer<float>& buffer);
+
+    // Audio thread, once a block: the gain sections, sidechain filters and envelopes (see FilterHealth)
+    FilterHealth::Repairs sanitiseState();
+
+    double getSampleRate() const { return _sample_rate; }
+    int getNumBands() const { return _design.num_bands; }
+
+private:
+    void detect(const float* sidechain, int numSamples);
+    void updateGains(); // At the start of each control interval
+
+    double _sample_rate = 44100.0;
+    int _num_channels = 0;
+    DynamicBandsDesign _design;
+
+    // Sidechain filter state and envelopes, one per band (the sidechain is mono)
+    std::array<float, DynamicBandsDesign::MAX_BANDS> _detector_z1{}, _detector_z2{}, _envelope{};
+    std::array<float, CONTROL_INTERVAL> _sidechain{};
+
+    GlidingSections _gains; // Every section identity until set
+    int _until_update = 0;
+
+    // Transposed direct form II state of the gain sections, [channel * MAX_SECTIONS + band]
+    std::vector<float> _z1, _z2;
+};
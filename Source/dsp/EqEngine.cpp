@@ -0,0 +1,168 @@
+#include <JuceHeader.h>
+#include "EqEngine.h"
+#include "BiquadCascade.h"
+
+namespace
+{
+    std::array<float*, 5> coefficients(CoefficientBank& bank)
+    {
+        return { bank.b0.data(), bank.b1.data(), bank.b2.data(), bank.a1.data(), bank.a2.data() };
+    }
+
+    void setIdentity(CoefficientBank& bank, int from, int to)
+    {
+        for (int s = from; s < to; ++s)
+            bank.setSection(s, Biquad{});
+    }
+}
+
+void EqEngine::prepare(double sampleRate, int maximumBlockSize, int numChannels)
+{
+    juce::ignoreUnused(maximumBlockSize);
+
+    _sample_rate = sampleRate;
+    _num_channels = numChannels;
+
+    _z1.assign(static_cast<size_t>(numChannels) * CoefficientBank::MAX_SECTIONS, 0.0f);
+    _z2.assign(static_cast<size_t>(numChannels) * CoefficientBank::MAX_SECTIONS, 0.0f);
+
+    _ramp_length = juce::jmax(1, juce::roundToInt(sampleRate * RAMP_SECONDS));
+    _ramp_remaining = 0;
+    _has_coefficients = false;
+}
+
+void EqEngine::reset()
+{
+    std::fill(_z1.begin(), _z1.end(), 0.0f);
+    std::fill(_z2.begin(), _z2.end(), 0.0f);
+}
+
+void EqEngine::setCoefficients(const CoefficientBank& bank, bool smooth)
+{
+    const int previous = _bank.num_sections;
+    smooth = smooth && _has_coefficients;
+    _has_coefficients = true;
+
+    // Glide from where we are now: the running cascade, or partway along the last glide
+    if (smooth && _ramp_remaining == 0)
+        _ramp_start = _bank;
+
+    _bank = bank;
+    _num_target_sections = bank.num_sections;
+    _replaced += FilterHealth::sanitise(_bank);
+
+    if (smooth)
+    {
+        // Pad both ends to whole lane groups of identity sections, whose step is then zero
+        const int lanes = BiquadCascade::getNumLanes();
+        const int count = juce::jmin(CoefficientBank::MAX_SECTIONS,
+                                     (juce::jmax(_ramp_start.num_sections, bank.num_sections) + lanes - 1) / lanes * lanes);
+        setIdentity(_ramp_start, _ramp_start.num_sections, count);
+        setIdentity(_bank, bank.num_sections, count);
+        _ramp_start.num_sections = _ramp_step.num_sections = _bank.num_sections = count;
+
+        const auto from = coefficients(_ramp_start);
+        const auto to = coefficients(_bank);
+        const auto step = coefficients(_ramp_step);
+        for (size_t c = 0; c < step.size(); ++c)
+        {
+            juce::FloatVectorOperations::subtract(step[c], to[c], from[c], count);
+            juce::FloatVectorOperations::multiply(step[c], 1.0f / (float)_ramp_length, count);
+        }
+
+        _ramp_remaining = _ramp_length;
+    }
+    else
+    {
+        _ramp_remaining = 0;
+    }
+
+    BiquadCascade::padToLanes(_bank);
+
+    // Sections that just came into use must not start from stale state
+    for (int ch = 0; ch < _num_channels; ++ch)
+    {
+        for (int s = previous; s < _bank.num_sections; ++s)
+        {
+            _z1[ch * CoefficientBank::MAX_SECTIONS + s] = 0.0f;
+            _z2[ch * CoefficientBank::MAX_SECTIONS + s] = 0.0f;
+        }
+    }
+}
+
+void EqEngine::process(juce::AudioBuffer<float>& buffer)
+{
+    process(buffer, 0, buffer.getNumSamples());
+}
+
+void EqEngine::process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    int done = 0;
+
+    if (_ramp_remaining > 0)
+    {
+        const int rampSamples = juce::jmin(numSamples, _ramp_remaining);
+        processSections(buffer, startSample, rampSamples, true);
+        done = rampSamples;
+
+        // Every channel started from the same point, so advance it once for all of them
+        _ramp_remaining -= rampSamples;
+        if (_ramp_remaining > 0)
+        {
+            const auto from = coefficients(_ramp_start);
+            const auto step = coefficients(_ramp_step);
+            for (size_t c = 0; c < step.size(); ++c)
+                juce::FloatVectorOperations::addWithMultiply(from[c], step[c], (float)rampSamples, _ramp_start.num_sections);
+        }
+        else
+        {
+            // Landed exactly on the target; drop the identity sections that padded the glide
+            _bank.num_sections = _num_target_sections;
+            BiquadCascade::padToLanes(_bank);
+        }
+    }
+
+    if (done < numSamples)
+        processSections(buffer, startSample + done, numSamples - done, false);
+}
+
+FilterHealth::Repairs EqEngine::sanitiseState()
+{
+    auto repairs = _replaced;
+    _replaced = {};
+
+    // While gliding, _bank covers every section either end of the glide uses
+    for (int ch = 0; ch < _num_channels; ++ch)
+        repairs += FilterHealth::sanitise(_z1.data() + ch * CoefficientBank::MAX_SECTIONS,
+                                          _z2.data() + ch * CoefficientBank::MAX_SECTIONS, _bank.num_sections);
+
+    return repairs;
+}
+
+void EqEngine::processSections(juce::AudioBuffer<float>& buffer, int start, int numSamples, bool ramp)
+{
+    const int numChannels = juce::jmin(buffer.getNumChannels(), _num_channels);
+
+    // Wide buses: every channel at once, a lane each, rather than one channel after another
+    if (BiquadCascade::prefersChannelLanes(numChannels))
+    {
+        float* const* channels = buffer.getArrayOfWritePointers();
+        if (ramp)
+            BiquadCascade::processChannelsRamp(_ramp_start, _ramp_step, _z1.data(), _z2.data(), channels, numChannels, start, numSamples);
+        else
+            BiquadCascade::processChannels(_bank, _z1.data(), _z2.data(), channels, numChannels, start, numSamples);
+        return;
+    }
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        float* z1 = _z1.data() + ch * CoefficientBank::MAX_SECTIONS;
+        float* z2 = _z2.data() + ch * CoefficientBank::MAX_SECTIONS;
+        float* data = buffer.getWritePointer(ch, start);
+
+        if (ramp)
+            BiquadCascade::processRamp(_ramp_start, _ramp_step, z1, z2, data, numSamples);
+        else
+            BiquadCascade::process(_bank, z1, z2, data, numSamples);
+    }
+}
@@ -0,0 +1,63 @@
+/* Audio-thread side of the EQ: runs the biquad cascade described by a CoefficientBank */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "CurveDesigner.h"
+#include "FilterHealth.h"
+
+class EqEngine
+{
+public:
+    // Allocates all filter state up front. Not real-time safe.
+    void prepare(double sampleRate, int maximumBlockSize, int numChannels);
+    void reset();
+
+    // Move to a freshly designed cascade. The coefficients glide there linearly over
+    // RAMP_SECONDS, starting from wherever a previous glide had got to, unless smooth is
+    // false (or nothing has been set since prepare()). Real-time safe: copies into preallocated storage.
+    // Sections that aren't stable, or aren't finite, run as identity instead.
+    void setCoefficients(const CoefficientBank& bank, bool smooth = true);
+
+    // Filters every prepared channel in place, channels across vector lanes when there
+    // are enough of them (see BiquadCascade::prefersChannelLanes()). Real-time safe.
+    void process(juce::AudioBuffer<float>& buffer);
+    // The same for numSamples of buffer from startSample on, for callers splitting a block
+    void process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    // Audio thread, once a block: flushes denormal state and resets sections whose state
+    // has gone non-finite (see FilterHealth). Reports those, and the sections setCoefficients()
+    // has replaced since the last call.
+    FilterHealth::Repairs sanitiseState();
+
+    double getSampleRate() const { return _sample_rate; }
+    int getNumSections() const { return _bank.num_sections; }
+    bool isRamping() const { return _ramp_remaining > 0; }
+
+    static constexpr double RAMP_SECONDS = 0.02;
+
+private:
+    void processSections(juce::AudioBuffer<float>& buffer, int start, int numSamples, bool ramp);
+
+    double _sample_rate = 44100.0;
+    int _num_channels = 0;
+    bool _has_coefficients = false;
+
+    // Target of the current glide, or the running cascade when not gliding
+    CoefficientBank _bank;
+    int _num_target_sections = 0;
+
+    // Per-sample linear glide: coefficients for the next sample, and their increment.
+    // Interpolating each section's (a1, a2) stays inside the stability triangle, which is
+    // convex, so no in-between section is unstable. While gliding, both banks and _bank
+    // cover the larger section count of the two designs, with identity sections to pad.
+    CoefficientBank _ramp_start, _ramp_step;
+    int _ramp_length = 1;
+    int _ramp_remaining = 0;
+
+    FilterHealth::Repairs _replaced; // By setCoefficients(), until sanitiseState() reports them
+
+    // Transposed direct form II state, [channel * MAX_SECTIONS + section]
+    std::vector<float> _z1, _z2;
+};
@@ -0,0 +1,116 @@
+#include <JuceHeader.h>
+#include <cmath>
+#include <cstring>
+#include "FilterHealth.h"
+
+namespace
+{
+    // On the bits rather than float compares, which see denormals as zero with DAZ on and
+    // may not see NaN at all with fast math
+    constexpr juce::uint32 ABS = 0x7fffffff, EXPONENT = 0x7f800000;
+
+    juce::uint32 bitsOf(float value)
+    {
+        juce::uint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    bool isNonFinite(juce::uint32 bits) { return (bits & EXPONENT) == EXPONENT; }
+    bool isDenormal(juce::uint32 bits) { return (bits & EXPONENT) == 0 && (bits & ABS) != 0; }
+
+    // True if any value is denormal or isn't finite. The same tests as above, but read-only,
+    // with no branches and compares for equality only, which every vector instruction set
+    // has, so this is the cheap pass made every block.
+    bool needsRepair(const float* values, int count)
+    {
+        juce::uint32 found = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            const auto bits = bitsOf(values[i]);
+            const auto exponent = bits & EXPONENT;
+            found |= (juce::uint32)(exponent == EXPONENT) | ((juce::uint32)(exponent == 0) & (juce::uint32)((bits & ABS) != 0));
+        }
+
+        return found != 0;
+    }
+}
+
+FilterHealth::Repairs FilterHealth::sanitise(float* z1, float* z2, int numSections)
+{
+    if (! needsRepair(z1, numSections) && ! needsRepair(z2, numSections))
+        return {};
+
+    // Rarely gets here, so plainly
+    Repairs repairs;
+    for (int i = 0; i < numSections; ++i)
+    {
+        const auto bits1 = bitsOf(z1[i]), bits2 = bitsOf(z2[i]);
+
+        if (isNonFinite(bits1) || isNonFinite(bits2))
+        {
+            z1[i] = z2[i] = 0.0f;
+            ++repairs.reset;
+        }
+        else if (isDenormal(bits1) || isDenormal(bits2))
+        {
+            z1[i] = isDenormal(bits1) ? 0.0f : z1[i];
+            z2[i] = isDenormal(bits2) ? 0.0f : z2[i];
+            ++repairs.flushed;
+        }
+    }
+
+    return repairs;
+}
+
+FilterHealth::Repairs FilterHealth::sanitise(float* values, int count)
+{
+    if (! needsRepair(values, count))
+        return {};
+
+    Repairs repairs;
+    for (int i = 0; i < count; ++i)
+    {
+        const auto bits = bitsOf(values[i]);
+
+        if (isNonFinite(bits))
+        {
+            values[i] = 0.0f;
+            ++repairs.reset;
+        }
+        else if (isDenormal(bits))
+        {
+            values[i] = 0.0f;
+            ++repairs.flushed;
+        }
+    }
+
+    return repairs;
+}
+
+FilterHealth::Repairs FilterHealth::sanitise(CoefficientBank& bank)
+{
+    // Stable means both poles inside the unit circle: the (a1, a2) triangle |a2| < 1,
+    // |a1| < 1 + a2. Every compare is false for NaN, so a NaN anywhere fails too.
+    const auto isGood = [&bank](int s)
+    {
+        constexpr float LARGEST = 3.4e38f;
+        const float a1 = bank.a1[(size_t)s], a2 = bank.a2[(size_t)s];
+        return (std::abs(a2) < 1.0f) & (std::abs(a1) < 1.0f + a2)
+             & (std::abs(bank.b0[(size_t)s]) < LARGEST) & (std::abs(bank.b1[(size_t)s]) < LARGEST)
+             & (std::abs(bank.b2[(size_t)s]) < LARGEST);
+    };
+
+    int bad = 0;
+    for (int s = 0; s < bank.num_sections; ++s)
+        bad += isGood(s) ? 0 : 1;
+
+    if (bad == 0)
+        return {};
+
+    for (int s = 0; s < bank.num_sections; ++s)
+        if (! isGood(s))
+            bank.setSection(s, Biquad{});
+
+    return { 0, 0, bad };
+}
@@ -0,0 +1,51 @@
+/* Once-a-block repairs for recursive filters' state and coefficients */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CurveDesigner.h"
+
+/* A recursive filter's state decays towards zero through the denormal range, where some
+   CPUs slow to a crawl unless flush-to-zero is on. ScopedNoDenormals turns it on for
+   processBlock, but hosts and other plugins on the same thread don't all leave it alone,
+   and with sections at 10 Hz the decay takes a long time. And once a NaN or Inf gets into
+   a recursive filter's state, from bad input or a bad section, it never leaves.
+
+   So each engine sanitises its state once a block: denormal values are flushed to zero,
+   and a section whose state has gone non-finite starts over from silence. A denormal can
+   still last until the end of the block it appears in, but no longer. The checks work on
+   the bits (DAZ makes float compares see denormals as zero) with no branches, so the
+   compiler vectorises them. */
+class FilterHealth
+{
+public:
+    // What a check repaired, in sections (or values)
+    struct Repairs
+    {
+        int flushed = 0;  // Denormal state flushed to zero
+        int reset = 0;    // Non-finite state reset to zero
+        int replaced = 0; // Unstable or non-finite sections replaced with identity
+
+        bool any() const { return (flushed | reset | replaced) != 0; }
+
+        Repairs& operator+=(const Repairs& other)
+        {
+            flushed += other.flushed;
+            reset += other.reset;
+            replaced += other.replaced;
+            return *this;
+        }
+    };
+
+    // Transposed direct form II state: section i is z1[i] and z2[i]. Both are reset if
+    // either isn't finite.
+    static Repairs sanitise(float* z1, float* z2, int numSections);
+
+    // Lone recursive values, such as envelopes
+    static Repairs sanitise(float* values, int count);
+
+    // Sections with a pole on or outside the unit circle, or a coefficient that isn't
+    // finite, become identity. Cheap enough for the audio thread: one pass over the bank,
+    // and a second only if something needs replacing.
+    static Repairs sanitise(CoefficientBank& bank);
+};
@@ -0,0 +1,92 @@
+#include <JuceHeader.h>
+#include "FirDesigner.h"
+
+int FirDesigner::roundLength(int length)
+{
+    return juce::jlimit(MIN_LENGTH, MAX_LENGTH, juce::nextPowerOfTwo(length));
+}
+
+void FirDesigner::design(const CurveSnapshot& curve, double sampleRate, int length,
+                         PartitionedKernel& head, PartitionedKernel& tail)
+{
+    length = roundLength(length);
+    const int order = juce::roundToInt(std::log2((double)length));
+    const int half = length / 2;
+
+    _work.assign(2 * (size_t)length, 0.0f);
+
+    // Zero-phase target magnitude on bins 0..N/2. Bins are walked in increasing
+    // frequency, so the segment cursor only ever moves forward.
+    int segment = 1;
+    for (int k = 0; k <= half; ++k)
+    {
+        const float freq = (float)(k * sampleRate / length);
+        float gainDb;
+
+        if (curve.num_points == 0)
+            gainDb = 0.0f;
+        else if (freq <= curve.points[0].freq)
+            gainDb = curve.points[0].gain;
+        else if (freq >= curve.points[curve.num_points - 1].freq)
+            gainDb = curve.points[curve.num_points - 1].gain;
+        else
+        {
+            while (curve.points[segment].freq < freq)
+                ++segment;
+
+            const auto& a = curve.points[segment - 1];
+            const auto& b = curve.points[segment];
+            const float t = (b.freq > a.freq) ? std::log(freq / a.freq) / std::log(b.freq / a.freq) : 1.0f;
+            gainDb = a.gain + t * (b.gain - a.gain);
+        }
+
+        _work[2 * (size_t)k] = juce::Decibels::decibelsToGain(gainDb, -200.0f);
+    }
+
+    juce::dsp::FFT(order).performRealOnlyInverseTransform(_work.data());
+
+    // The impulse is centred on sample 0 (wrapping round); rotate it to the middle
+    // and window it. The result is symmetric about 'half', hence linear phase.
+    _taps.resize((size_t)length);
+    for (int n = 0; n < length; ++n)
+    {
+        const double w = 0.42 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * n / length)
+                              + 0.08 * std::cos(2.0 * juce::MathConstants<double>::twoPi * n / length);
+        _taps[(size_t)n] = _work[(size_t)((n + half) % length)] * (float)w;
+    }
+
+    _sample_rate = sampleRate;
+    _length = length;
+
+    partition(0, juce::jmin(length, TAIL_OFFSET), HEAD_ORDER, head);
+    partition(TAIL_OFFSET, juce::jmax(0, length - TAIL_OFFSET), TAIL_ORDER, tail);
+}
+
+void FirDesigner::partition(int firstTap, int numTaps, int order, PartitionedKernel& kernel)
+{
+    const int size = 1 << order;
+    const int numBins = size + 1;
+    const int numPartitions = (numTaps + size - 1) / size;
+
+    kernel.partition_order = order;
+    kernel.num_partitions = numPartitions;
+    kernel.length = _length;
+    kernel.sample_rate = _sample_rate;
+    kernel.spectra.resize((size_t)numPartitions * numBins);
+
+    juce::dsp::FFT fft(order + 1);
+    _partition.resize(4 * (size_t)size);
+
+    for (int p = 0; p < numPartitions; ++p)
+    {
+        const int count = juce::jmin(size, numTaps - p * size);
+
+        std::fill(_partition.begin(), _partition.end(), 0.0f);
+        std::copy_n(_taps.begin() + firstTap + p * size, count, _partition.begin());
+
+        fft.performRealOnlyForwardTransform(_partition.data(), true);
+
+        auto* bins = reinterpret_cast<const std::complex<float>*>(_partition.data());
+        std::copy_n(bins, numBins, kernel.spectra.begin() + (size_t)p * numBins);
+    }
+}
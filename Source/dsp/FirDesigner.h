@@ -0,0 +1,57 @@
+/* Linear-phase FIR design from the drawn curve */
+
+#pragma once
+
+#include <complex>
+#include <vector>
+#include "Curve.h"
+
+/* One uniformly partitioned segment of an FIR, ready for PartitionedConvolver.
+   Partition p holds its partition_size taps zero-padded to twice that size,
+   transformed to partition_size + 1 complex bins. */
+struct PartitionedKernel
+{
+    int partition_order = 0;
+    int num_partitions = 0;
+    int length = 0;             // Taps of the whole filter this segment belongs to
+    double sample_rate = 0.0;
+    std::vector<std::complex<float>> spectra; // num_partitions * getNumBins()
+
+    int getPartitionSize() const { return 1 << partition_order; }
+    int getNumBins() const { return getPartitionSize() + 1; }
+    const std::complex<float>* getPartition(int index) const { return spectra.data() + (size_t)index * getNumBins(); }
+};
+
+/* Samples the curve's magnitude onto an FFT grid, turns it into a zero-phase
+   impulse, centres it and applies a Blackman window. CPU cost only depends on
+   the filter length. Allocates on first use, so keep it off the audio thread.
+
+   The taps are split for NonUniformConvolver: a head of small partitions covering
+   [0, TAIL_OFFSET) and a tail of large partitions covering the rest. */
+class FirDesigner
+{
+public:
+    static constexpr int HEAD_ORDER = 7;                     // 128-sample partitions
+    static constexpr int TAIL_ORDER = 11;                    // 2048-sample partitions
+    static constexpr int TAIL_OFFSET = 2 << TAIL_ORDER;      // Gives the tail a full partition of slack
+    static constexpr int MIN_LENGTH = 1024;
+    static constexpr int MAX_LENGTH = 65536;
+
+    // length is rounded up to a power of two in [MIN_LENGTH, MAX_LENGTH]
+    void design(const CurveSnapshot& curve, double sampleRate, int length,
+                PartitionedKernel& head, PartitionedKernel& tail);
+
+    static int roundLength(int length);
+
+    // Pure delay of a linear-phase filter of this many taps
+    static int getGroupDelay(int length) { return length / 2; }
+
+private:
+    void partition(int firstTap, int numTaps, int order, PartitionedKernel& kernel);
+
+    std::vector<float> _work;      // 2 * length, for the full-length FFT
+    std::vector<float> _taps;
+    std::vector<float> _partition; // For the partition FFTs
+    double _sample_rate = 0.0;
+    int _length = 0;
+};
@@ -0,0 +1,102 @@
+#include <JuceHeader.h>
+#include "GlidingSections.h"
+#include "BiquadCascade.h"
+
+namespace
+{
+    std::array<float*, 5> coefficients(CoefficientBank& bank)
+    {
+        return { bank.b0.data(), bank.b1.data(), bank.b2.data(), bank.a1.data(), bank.a2.data() };
+    }
+}
+
+void GlidingSections::clear()
+{
+    for (int s = 0; s < CoefficientBank::MAX_SECTIONS; ++s)
+    {
+        sections.setSection(s, Biquad{});
+        targets.setSection(s, Biquad{});
+        step.setSection(s, { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f });
+    }
+
+    gliding = active = targets_active = false;
+}
+
+void GlidingSections::snap(bool targetsActive)
+{
+    sections = targets;
+    step.num_sections = targets.num_sections;
+    gliding = false;
+    active = targets_active = targetsActive;
+}
+
+bool GlidingSections::startInterval(int numSections, int numSamples, bool moving, bool targetsActive)
+{
+    // The sections start the interval on the last one's targets, so with nothing moving
+    // there's nothing to glide
+    gliding = moving;
+    if (gliding)
+    {
+        const auto from = coefficients(sections);
+        const auto to = coefficients(targets);
+        const auto steps = coefficients(step);
+
+        for (size_t c = 0; c < steps.size(); ++c)
+        {
+            juce::FloatVectorOperations::subtract(steps[c], to[c], from[c], numSections);
+            juce::FloatVectorOperations::multiply(steps[c], 1.0f / (float)numSamples, numSections);
+        }
+    }
+
+    const bool wasActive = active;
+    active = targetsActive || targets_active;
+    targets_active = targetsActive;
+
+    return active && ! wasActive;
+}
+
+void GlidingSections::process(float* z1, float* z2, float* const* channels, int numChannels, int startSample, int numSamples) const
+{
+    if (! active)
+        return;
+
+    if (BiquadCascade::prefersChannelLanes(numChannels))
+    {
+        if (gliding)
+            BiquadCascade::processChannelsRamp(sections, step, z1, z2, channels, numChannels, startSample, numSamples);
+        else
+            BiquadCascade::processChannels(sections, z1, z2, channels, numChannels, startSample, numSamples);
+
+        return;
+    }
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        float* const s1 = z1 + ch * CoefficientBank::MAX_SECTIONS;
+        float* const s2 = z2 + ch * CoefficientBank::MAX_SECTIONS;
+
+        if (gliding)
+            BiquadCascade::processRamp(sections, step, s1, s2, channels[ch] + startSample, numSamples);
+        else
+            BiquadCascade::process(sections, s1, s2, channels[ch] + startSample, numSamples);
+    }
+}
+
+void GlidingSections::advance(int numSections, int numSamples, int untilEnd)
+{
+    if (! gliding)
+        return;
+
+    // Land exactly on the targets at the end of the interval, or go partway
+    const auto from = coefficients(sections);
+    const auto to = coefficients(targets);
+    const auto steps = coefficients(step);
+
+    for (size_t c = 0; c < from.size(); ++c)
+    {
+        if (untilEnd == 0)
+            juce::FloatVectorOperations::copy(from[c], to[c], numSections);
+        else
+            juce::FloatVectorOperations::addWithMultiply(from[c], steps[c], (float)numSamples, numSections);
+    }
+}
@@ -0,0 +1,38 @@
+/* Biquad sections that glide to new coefficients across each control interval */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CurveDesigner.h"
+
+/* For stages that work out their sections' coefficients once every control interval
+   (BreakpointBands, DynamicBands): the owner fills targets with where the sections should
+   be at the end of the interval, and the sections move there linearly, a step per sample,
+   through BiquadCascade's ramp kernels. If nothing moved the plain kernels run instead,
+   and with every section at 0 dB at both ends of the interval, passing the audio straight
+   through, none run at all. The owner keeps the sections' state, [channel * MAX_SECTIONS
+   + section] as for BiquadCascade::process(). */
+struct GlidingSections
+{
+    // Sections at the next sample, their per-sample step to the end of the interval, and that end
+    CoefficientBank sections, step, targets;
+    bool gliding = false;        // The sections change over the interval
+    bool active = false;         // Some section is away from 0 dB at either end of the interval
+    bool targets_active = false; // Some section is away from 0 dB at its end
+
+    // Every section identity and still
+    void clear();
+    // Straight onto the targets, nothing to glide
+    void snap(bool targetsActive);
+
+    // Once targets holds the end of a new interval of numSamples: sets the first numSections
+    // sections gliding there, or holding still if none moved. True if the sections have just
+    // come back into use, when their state should start over from silence.
+    bool startInterval(int numSections, int numSamples, bool moving, bool targetsActive);
+
+    // Runs the sections, if active, over every channel's samples [startSample, startSample + numSamples)
+    void process(float* z1, float* z2, float* const* channels, int numChannels, int startSample, int numSamples) const;
+    // Moves the first numSections sections numSamples further on, landing on the targets when
+    // the interval has untilEnd samples left
+    void advance(int numSections, int numSamples, int untilEnd);
+};
@@ -0,0 +1,281 @@
+#include <JuceHeader.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "MeasurementImporter.h"
+
+namespace
+{
+    bool isSeparator(char c) { return c == ' ' || c == '\t' || c == ',' || c == ';' || c == '\r'; }
+    bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    double powerOfTen(int exponent)
+    {
+        static constexpr double table[] = { 1e-22, 1e-21, 1e-20, 1e-19, 1e-18, 1e-17, 1e-16, 1e-15, 1e-14, 1e-13, 1e-12,
+                                            1e-11, 1e-10, 1e-9, 1e-8, 1e-7, 1e-6, 1e-5, 1e-4, 1e-3, 1e-2, 1e-1,
+                                            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+        if (exponent >= -22 && exponent <= 22)
+            return table[exponent + 22];
+        return std::pow(10.0, exponent);
+    }
+
+    /* Decimal number starting at p, advancing p past it. Unlike strtod it needs no
+       terminator and ignores the locale, and it's a good deal quicker. */
+    bool parseNumber(const char*& p, const char* end, double& value)
+    {
+        const char* s = p;
+        bool negative = false;
+        if (s < end && (*s == '-' || *s == '+'))
+            negative = (*s++ == '-');
+
+        juce::uint64 mantissa = 0;
+        int digits = 0, exponent = 0;
+        bool any = false;
+
+        for (; s < end && isDigit(*s); ++s, any = true)
+        {
+            if (digits < 18) { mantissa = mantissa * 10 + (juce::uint64)(*s - '0'); digits += mantissa != 0; }
+            else             ++exponent;
+        }
+        if (s < end && *s == '.')
+        {
+            for (++s; s < end && isDigit(*s); ++s, any = true)
+            {
+                if (digits < 18) { mantissa = mantissa * 10 + (juce::uint64)(*s - '0'); digits += mantissa != 0; --exponent; }
+            }
+        }
+        if (! any)
+            return false;
+
+        if (s < end && (*s == 'e' || *s == 'E'))
+        {
+            const char* t = s + 1;
+            bool negativeExponent = false;
+            if (t < end && (*t == '-' || *t == '+'))
+                negativeExponent = (*t++ == '-');
+
+            if (t < end && isDigit(*t))
+            {
+                int e = 0;
+                for (; t < end && isDigit(*t); ++t)
+                    e = std::min(e * 10 + (*t - '0'), 10000);
+                exponent += negativeExponent ? -e : e;
+                s = t;
+            }
+        }
+
+        // Multiplying by an inexact 1e-n is off by an ulp of a double, far below float precision
+        const double magnitude = (double)mantissa * powerOfTen(exponent);
+        value = negative ? -magnitude : magnitude;
+        p = s;
+        return true;
+    }
+
+    void skipSeparators(const char*& p, const char* end)
+    {
+        while (p < end && isSeparator(*p))
+            ++p;
+    }
+}
+
+juce::Result MeasurementImporter::importFile(const juce::File& file, const Options& options, std::vector<std::pair<float, float>>& dots)
+{
+    if (! file.existsAsFile())
+        return juce::Result::fail(file.getFullPathName() + " doesn't exist");
+
+    const juce::MemoryMappedFile mapped(file, juce::MemoryMappedFile::readOnly);
+    if (mapped.getData() != nullptr)
+        return importText(static_cast<const char*>(mapped.getData()), mapped.getSize(), options, dots);
+
+    // Mapping fails for empty files and some network shares: fall back to reading it in
+    juce::MemoryBlock block;
+    if (! file.loadFileAsData(block))
+        return juce::Result::fail("Couldn't read " + file.getFullPathName());
+
+    return importText(static_cast<const char*>(block.getData()), block.getSize(), options, dots);
+}
+
+juce::Result MeasurementImporter::importText(const char* text, size_t size, const Options& options, std::vector<std::pair<float, float>>& dots)
+{
+    parse(text, size);
+    if (_points.empty())
+        return juce::Result::fail("No frequency / level rows found");
+
+    prepare(options);
+    if (_points.size() < 2)
+        return juce::Result::fail("Fewer than two rows in the graph's frequency range");
+
+    smooth(options.smoothing_octaves);
+    simplify(std::max(options.tolerance_db, 0.0f), juce::jlimit(2, CurveSnapshot::MAX_POINTS, options.max_points));
+
+    dots.clear();
+    for (size_t i = 0; i < _points.size(); ++i)
+        if (_keep[i])
+            dots.emplace_back(_points[i].freq, _points[i].gain);
+
+    return juce::Result::ok();
+}
+
+void MeasurementImporter::parse(const char* text, size_t size)
+{
+    _points.clear();
+    _points.reserve(size / 16); // Rows are rarely shorter
+
+    const char* p = text;
+    const char* const end = text + size;
+
+    // UTF-8 byte order mark
+    if (size >= 3 && std::memcmp(p, "\xEF\xBB\xBF", 3) == 0)
+        p += 3;
+
+    while (p < end)
+    {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', (size_t)(end - p)));
+        if (lineEnd == nullptr)
+            lineEnd = end;
+
+        double freq = 0.0, gain = 0.0;
+        skipSeparators(p, lineEnd);
+        if (parseNumber(p, lineEnd, freq))
+        {
+            skipSeparators(p, lineEnd);
+            if (parseNumber(p, lineEnd, gain) && freq > 0.0 && std::isfinite(freq) && std::isfinite(gain))
+                _points.push_back({ (float)freq, (float)gain });
+        }
+
+        // Past the newline, if there is one: the last line may have none
+        p = lineEnd < end ? lineEnd + 1 : end;
+    }
+
+    _num_rows = (int)_points.size();
+}
+
+void MeasurementImporter::prepare(const Options& options)
+{
+    auto byFrequency = [](const CurvePoint& a, const CurvePoint& b) { return a.freq < b.freq; };
+    if (! std::is_sorted(_points.begin(), _points.end(), byFrequency))
+        std::stable_sort(_points.begin(), _points.end(), byFrequency);
+
+    // Keep the graph's range, one row per frequency
+    size_t count = 0;
+    for (const auto& point : _points)
+    {
+        if (point.freq < options.min_freq || point.freq > options.max_freq)
+            continue;
+        if (count > 0 && point.freq <= _points[count - 1].freq)
+            continue;
+        _points[count++] = point;
+    }
+    _points.resize(count);
+
+    if (count < 2)
+        return;
+
+    // Level at the normalisation frequency, interpolated in log frequency like the curve
+    float offset = 0.0f;
+    if (options.normalise_freq > 0.0f)
+    {
+        const auto hi = std::lower_bound(_points.begin(), _points.end(), CurvePoint{ options.normalise_freq, 0.0f }, byFrequency);
+        if (hi == _points.begin())
+            offset = hi->gain;
+        else if (hi == _points.end())
+            offset = _points.back().gain;
+        else
+        {
+            const auto& a = *(hi - 1);
+            const auto& b = *hi;
+            const float t = std::log(options.normalise_freq / a.freq) / std::log(b.freq / a.freq);
+            offset = a.gain + t * (b.gain - a.gain);
+        }
+    }
+
+    const float sign = options.invert ? -1.0f : 1.0f;
+    _log_freqs.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        _points[i].gain = juce::jlimit(-options.max_gain_db, options.max_gain_db, sign * (_points[i].gain - offset));
+        _log_freqs[i] = std::log10(_points[i].freq);
+    }
+}
+
+void MeasurementImporter::smooth(float octaves)
+{
+    const int n = (int)_points.size();
+    if (octaves <= 0.0f || n < 3)
+        return;
+
+    // Running sums make the moving average O(n) however many rows fall in the window
+    _prefix.resize((size_t)n + 1);
+    _prefix[0] = 0.0;
+    for (int i = 0; i < n; ++i)
+        _prefix[(size_t)i + 1] = _prefix[(size_t)i] + _points[(size_t)i].gain;
+
+    // Both window edges only ever move up, since the rows are sorted
+    const float halfWidth = 0.5f * octaves * std::log10(2.0f);
+    int lo = 0, hi = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        while (_log_freqs[(size_t)lo] < _log_freqs[(size_t)i] - halfWidth)
+            ++lo;
+        while (hi < n && _log_freqs[(size_t)hi] <= _log_freqs[(size_t)i] + halfWidth)
+            ++hi;
+        _points[(size_t)i].gain = (float)((_prefix[(size_t)hi] - _prefix[(size_t)lo]) / (hi - lo));
+    }
+}
+
+MeasurementImporter::Segment MeasurementImporter::findWorst(int first, int last) const
+{
+    // Distance is measured straight down in dB, not perpendicular, so the error
+    // bounds the level wherever the curve is evaluated
+    const float x0 = _log_freqs[(size_t)first];
+    const float y0 = _points[(size_t)first].gain;
+    const float slope = (_points[(size_t)last].gain - y0) / (_log_freqs[(size_t)last] - x0);
+
+    Segment segment{ first, last, first, 0.0f };
+    for (int i = first + 1; i < last; ++i)
+    {
+        const float error = std::abs(_points[(size_t)i].gain - (y0 + slope * (_log_freqs[(size_t)i] - x0)));
+        if (error > segment.error)
+        {
+            segment.error = error;
+            segment.worst = i;
+        }
+    }
+    return segment;
+}
+
+void MeasurementImporter::simplify(float toleranceDb, int maxPoints)
+{
+    const int n = (int)_points.size();
+    _keep.assign((size_t)n, 0);
+    _keep.front() = _keep.back() = 1;
+    int count = 2;
+
+    // Ramer-Douglas-Peucker, but always splitting the worst segment left rather than
+    // recursing, so stopping at maxPoints leaves the best curve of that size. No
+    // recursion either: a 100k row file can go deep.
+    _heap.clear();
+    _heap.push_back(findWorst(0, n - 1));
+
+    while (! _heap.empty() && _heap.front().error > toleranceDb && count < maxPoints)
+    {
+        std::pop_heap(_heap.begin(), _heap.end());
+        const Segment segment = _heap.back();
+        _heap.pop_back();
+
+        _keep[(size_t)segment.worst] = 1;
+        ++count;
+
+        for (const auto& half : { findWorst(segment.first, segment.worst), findWorst(segment.worst, segment.last) })
+        {
+            if (half.error > 0.0f)
+            {
+                _heap.push_back(half);
+                std::push_heap(_heap.begin(), _heap.end());
+            }
+        }
+    }
+
+    _max_error_db = _heap.empty() ? 0.0f : _heap.front().error;
+}
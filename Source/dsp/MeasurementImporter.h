@@ -0,0 +1,68 @@
+/* Turns a measured frequency response file into an editable breakpoint curve */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <utility>
+#include <vector>
+#include "Curve.h"
+
+/* Reads the text exports of the usual measurement tools (REW, ARTA, AutoEQ CSV, ...):
+   one row per frequency, frequency in Hz then level in dB, separated by spaces, tabs,
+   commas or semicolons. Any further columns (phase, coherence) are ignored, and so is
+   every line that doesn't start with two numbers, which takes care of headers and
+   '*' / '#' comments.
+
+   The file is memory-mapped and parsed in place: no per-line strings, and the row
+   buffers are kept between imports. The rows are then reduced with Ramer-Douglas-Peucker
+   in (log frequency, dB), which is exactly how CurveSnapshot interpolates between dots.
+   Segments are split worst first, so when the tolerance would need more dots than
+   max_points the curve stops there with the smallest error it got to, in one pass. */
+class MeasurementImporter
+{
+public:
+    struct Options
+    {
+        float tolerance_db = 0.5f;                    // Max deviation of the curve from the measurement
+        int max_points = CurveSnapshot::MAX_POINTS;   // Takes priority over the tolerance
+        float smoothing_octaves = 1.0f / 24.0f;       // Moving average width before simplifying; 0 for none
+        float min_freq = 10.0f, max_freq = 20000.0f;  // Rows outside are dropped (the graph's range)
+        float max_gain_db = 24.0f;                    // Levels are clamped to +-this after normalising
+        float normalise_freq = 1000.0f;               // Level here becomes 0 dB; 0 to keep absolute levels
+        bool invert = false;                          // Import the correction rather than the measurement
+    };
+
+    // Message thread. On success dots is replaced by the curve, sorted by frequency.
+    juce::Result importFile(const juce::File& file, const Options& options, std::vector<std::pair<float, float>>& dots);
+
+    // Same, from text already in memory (need not be null-terminated)
+    juce::Result importText(const char* text, size_t size, const Options& options, std::vector<std::pair<float, float>>& dots);
+
+    // About the last import
+    int getNumRows() const { return _num_rows; }         // Measurement rows found in the file
+    float getMaxErrorDb() const { return _max_error_db; } // Above Options::tolerance_db if max_points ran out
+
+private:
+    struct Segment
+    {
+        int first, last; // Kept rows at both ends
+        int worst;       // Row furthest from the line between them
+        float error;     // ... and how far, in dB
+        bool operator<(const Segment& other) const { return error < other.error; }
+    };
+
+    void parse(const char* text, size_t size);
+    void prepare(const Options& options);
+    void smooth(float octaves);
+    Segment findWorst(int first, int last) const;
+    void simplify(float toleranceDb, int maxPoints);
+
+    std::vector<CurvePoint> _points;
+    std::vector<float> _log_freqs;
+    std::vector<double> _prefix;
+    std::vector<char> _keep;
+    std::vector<Segment> _heap;
+
+    int _num_rows = 0;
+    float _max_error_db = 0.0f;
+};
@@ -0,0 +1,271 @@
+#include <JuceHeader.h>
+#include "NonUniformConvolver.h"
+
+NonUniformConvolver::NonUniformConvolver()
+    : juce::Thread("FIR tail worker")
+{
+}
+
+NonUniformConvolver::~NonUniformConvolver()
+{
+    release();
+}
+
+void NonUniformConvolver::prepare(int numChannels)
+{
+    release();
+
+    _num_channels = numChannels;
+    _head.prepare(numChannels, FirDesigner::HEAD_ORDER, FirDesigner::TAIL_OFFSET / HEAD_SIZE);
+    _tail.prepare(numChannels, FirDesigner::TAIL_ORDER, MAX_TAIL_PARTITIONS);
+
+    const auto channels = [numChannels](int size) {
+        return std::vector<std::vector<float>>((size_t)numChannels, std::vector<float>((size_t)size, 0.0f));
+    };
+
+    _head_in = channels(HEAD_SIZE);
+    _head_out = channels(HEAD_SIZE);
+    _tail_in = channels(TAIL_SIZE);
+    _tail_play = channels(TAIL_SIZE);
+
+    for (auto& job : _jobs)
+    {
+        job.state = FREE;
+        job.index = -1;
+        job.input = channels(TAIL_SIZE);
+        job.output = channels(TAIL_SIZE);
+    }
+
+    _position = 0;
+    _head_blocks = 0;
+    _first_tail_job = 0;
+    _reset_tail = false;
+    _deadline_misses = 0;
+    _prepared = true;
+}
+
+void NonUniformConvolver::start()
+{
+    if (_prepared && ! isThreadRunning())
+        startThread(juce::Thread::Priority::high);
+}
+
+void NonUniformConvolver::stop()
+{
+    stopThread(1000);
+
+    // Lets an offline fetch waiting on a job see that nobody is left to run it
+    _job_done.signal();
+}
+
+void NonUniformConvolver::release()
+{
+    stop();
+    _prepared = false;
+}
+
+void NonUniformConvolver::setNonRealtime(bool isNonRealtime)
+{
+    _non_realtime.store(isNonRealtime, std::memory_order_relaxed);
+
+    // Takes a sleeping worker back to polling
+    notify();
+}
+
+void NonUniformConvolver::reset()
+{
+    _head.reset();
+    for (auto* buffers : { &_head_in, &_head_out, &_tail_in, &_tail_play })
+        for (auto& b : *buffers)
+            std::fill(b.begin(), b.end(), 0.0f);
+
+    // Drop whatever is in flight. Head blocks restart on a tail boundary so the
+    // phase bookkeeping in processHeadBlock() still lines up.
+    for (auto& job : _jobs)
+    {
+        int expected = QUEUED;
+        if (! job.state.compare_exchange_strong(expected, ABANDONED) && expected == DONE)
+            job.state = FREE;
+    }
+
+    _position = 0;
+    _head_blocks = (_head_blocks / HEADS_PER_TAIL + 1) * HEADS_PER_TAIL;
+    _first_tail_job.store(_head_blocks / HEADS_PER_TAIL, std::memory_order_relaxed);
+    _reset_tail.store(true, std::memory_order_release);
+}
+
+void NonUniformConvolver::publishKernel()
+{
+    _head_kernels.publish();
+    _tail_kernels.publish();
+}
+
+//==========================
+
+void NonUniformConvolver::process(juce::AudioBuffer<float>& buffer)
+{
+    _head_kernels.update();
+
+    const int numChannels = juce::jmin(buffer.getNumChannels(), _num_channels);
+    const int numSamples = buffer.getNumSamples();
+
+    int done = 0;
+    while (done < numSamples)
+    {
+        const int chunk = juce::jmin(numSamples - done, HEAD_SIZE - _position);
+
+        // Swap the host's samples for the ones computed one head partition ago
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* data = buffer.getWritePointer(ch, done);
+            std::copy_n(data, chunk, _head_in[(size_t)ch].begin() + _position);
+            std::copy_n(_head_out[(size_t)ch].begin() + _position, chunk, data);
+        }
+
+        _position += chunk;
+        done += chunk;
+
+        if (_position == HEAD_SIZE)
+        {
+            processHeadBlock(numChannels);
+            _position = 0;
+        }
+    }
+}
+
+void NonUniformConvolver::processHeadBlock(int numChannels)
+{
+    // Head block b holds input [b * HEAD_SIZE, (b + 1) * HEAD_SIZE) and produces the
+    // output for the same range, which is played out during the next head block
+    const int phase = (int)(_head_blocks % HEADS_PER_TAIL);
+    const auto tailIndex = _head_blocks / HEADS_PER_TAIL;
+
+    if (phase == 0)
+        fetchTailBlock(tailIndex);
+
+    const auto* kernel = &_head_kernels.getReadBuffer();
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto& in = _head_in[(size_t)ch];
+        auto& out = _head_out[(size_t)ch];
+
+        std::copy(in.begin(), in.end(), _tail_in[(size_t)ch].begin() + phase * HEAD_SIZE);
+        _head.processPartition(ch, in.data(), out.data(), kernel);
+
+        juce::FloatVectorOperations::add(out.data(), _tail_play[(size_t)ch].data() + phase * HEAD_SIZE, HEAD_SIZE);
+    }
+
+    if (phase == HEADS_PER_TAIL - 1)
+        queueTailJob(tailIndex);
+
+    ++_head_blocks;
+}
+
+void NonUniformConvolver::fetchTailBlock(juce::int64 index)
+{
+    // Tail taps start TAIL_OFFSET = 2 * TAIL_SIZE in, so output block q comes from input block q - 2
+    const auto jobIndex = index - 2;
+    auto& job = _jobs[(size_t)(juce::jmax((juce::int64)0, jobIndex) % NUM_JOBS)];
+
+    bool ready = false;
+    if (jobIndex >= _first_tail_job.load(std::memory_order_relaxed) && job.index == jobIndex)
+    {
+        if (_non_realtime.load(std::memory_order_relaxed))
+            while (job.state.load(std::memory_order_acquire) == QUEUED && isThreadRunning())
+                _job_done.wait();
+
+        int expected = QUEUED;
+        ready = ! job.state.compare_exchange_strong(expected, ABANDONED) && expected == DONE;
+
+        if (! ready)
+            _deadline_misses.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    for (size_t ch = 0; ch < _tail_play.size(); ++ch)
+    {
+        if (ready)
+            std::copy(job.output[ch].begin(), job.output[ch].end(), _tail_play[ch].begin());
+        else
+            std::fill(_tail_play[ch].begin(), _tail_play[ch].end(), 0.0f);
+    }
+
+    if (ready)
+        job.state.store(FREE, std::memory_order_release);
+}
+
+void NonUniformConvolver::queueTailJob(juce::int64 index)
+{
+    auto& job = _jobs[(size_t)(index % NUM_JOBS)];
+
+    // The worker hasn't even got through the job NUM_JOBS blocks back. This input can't join
+    // the tail's history, so that history is no use to later blocks either: start it over.
+    if (job.state.load(std::memory_order_acquire) != FREE)
+    {
+        _deadline_misses.fetch_add(1, std::memory_order_relaxed);
+        _first_tail_job.store(index + 1, std::memory_order_relaxed);
+        _reset_tail.store(true, std::memory_order_release);
+        return;
+    }
+
+    for (size_t ch = 0; ch < _tail_in.size(); ++ch)
+        std::copy(_tail_in[ch].begin(), _tail_in[ch].end(), job.input[ch].begin());
+
+    job.index = index;
+    job.state.store(QUEUED, std::memory_order_release);
+
+    if (_non_realtime.load(std::memory_order_relaxed))
+        notify();
+}
+
+//==========================
+
+void NonUniformConvolver::run()
+{
+    while (! threadShouldExit())
+    {
+        wait(_non_realtime.load(std::memory_order_relaxed) ? -1 : POLL_MS);
+
+        for (;;)
+        {
+            if (_reset_tail.exchange(false, std::memory_order_acquire))
+                _tail.reset();
+
+            // Oldest job first, abandoned or not: each one's input is history for the blocks after it.
+            // Jobs from before a reset are recycled, run or not; the audio thread ignores them.
+            const auto first = _first_tail_job.load(std::memory_order_relaxed);
+            TailJob* next = nullptr;
+            juce::int64 nextIndex = 0;
+            for (auto& job : _jobs)
+            {
+                int state = job.state.load(std::memory_order_acquire);
+                const auto index = job.index.load(std::memory_order_relaxed);
+
+                // A CAS, since the audio thread may free and requeue a DONE job meanwhile
+                if (state != FREE && index < first)
+                    job.state.compare_exchange_strong(state, FREE, std::memory_order_acq_rel);
+                else if ((state == QUEUED || state == ABANDONED) && (next == nullptr || index < nextIndex))
+                {
+                    next = &job;
+                    nextIndex = index;
+                }
+            }
+
+            if (next == nullptr || threadShouldExit())
+                break;
+
+            _tail_kernels.update();
+            const auto* kernel = &_tail_kernels.getReadBuffer();
+
+            // Abandoned before we got to it: history only, nobody's waiting for the output
+            const bool wanted = next->state.load(std::memory_order_acquire) == QUEUED;
+            for (size_t ch = 0; ch < next->input.size(); ++ch)
+                _tail.processPartition((int)ch, next->input[ch].data(), wanted ? next->output[ch].data() : nullptr, kernel);
+
+            int expected = QUEUED;
+            if (! next->state.compare_exchange_strong(expected, DONE))
+                next->state.store(FREE, std::memory_order_release); // Abandoned
+
+            _job_done.signal();
+        }
+    }
+}
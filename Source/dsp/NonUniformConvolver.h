@@ -0,0 +1,114 @@
+/* Two-level non-uniform partitioned convolution for long linear-phase filters */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "PartitionedConvolver.h"
+#include "TripleBuffer.h"
+
+/* Gardner-style split of the FIR (see FirDesigner):
+     - the head, taps [0, TAIL_OFFSET), runs on the audio thread in small partitions,
+       so the whole convolver only adds HEAD_SIZE samples of latency;
+     - the tail, taps [TAIL_OFFSET, length), runs in large partitions on a worker thread.
+   Every TAIL_SIZE input samples a tail job is queued; its result is needed
+   TAIL_SIZE + HEAD_SIZE samples later, which is the worker's deadline. A late job is
+   counted as a deadline miss and its block of tail output is dropped, unless rendering
+   offline, when the audio thread waits for it instead. The worker still runs the late
+   job's input into the tail's history, since every tail block after it overlaps that
+   input; only the one block of output is lost.
+
+   Live, the audio thread never wakes the worker (juce::Thread::notify() takes a lock):
+   the worker polls the job states every POLL_MS, well inside a tail block. Offline the
+   audio thread may block, so it wakes the worker for each job and sleeps until the job
+   is done, and the worker sleeps until woken. The worker only runs between start() and
+   stop() or release(), so a convolver nobody is using costs nothing.
+
+   Kernels are published through two triple buffers: the audio thread reads the head,
+   the worker reads the tail, so neither can pull a kernel from under the other. */
+class NonUniformConvolver : private juce::Thread
+{
+public:
+    static constexpr int HEAD_SIZE = 1 << FirDesigner::HEAD_ORDER;
+    static constexpr int TAIL_SIZE = 1 << FirDesigner::TAIL_ORDER;
+
+    NonUniformConvolver();
+    ~NonUniformConvolver() override;
+
+    // Allocates everything and stops the worker. Not real-time safe.
+    void prepare(int numChannels);
+    // Starts the worker, if prepared; while it's stopped process() drops every tail block
+    void start();
+    void stop();
+    // Stops the worker until the next prepare()
+    void release();
+
+    // Clears the audio-thread state and asks the worker to clear its own. Real-time safe.
+    void reset();
+
+    // Offline, process() runs as fast as it can and must not lose tail blocks: it waits for a
+    // late one rather than drop it. Any thread but the audio thread.
+    void setNonRealtime(bool isNonRealtime);
+
+    //==========================
+    // Kernel writer side: one thread at a time
+
+    PartitionedKernel& getHeadKernelToWrite() { return _head_kernels.getWriteBuffer(); }
+    PartitionedKernel& getTailKernelToWrite() { return _tail_kernels.getWriteBuffer(); }
+    void publishKernel();
+
+    //==========================
+    // Audio thread
+
+    // Filters every prepared channel in place. Real-time safe.
+    void process(juce::AudioBuffer<float>& buffer);
+
+    static int getLatencySamples(int firLength) { return HEAD_SIZE + FirDesigner::getGroupDelay(firLength); }
+
+    // Tail blocks that weren't ready in time (or couldn't be queued) since prepare()
+    juce::uint32 getNumDeadlineMisses() const { return _deadline_misses.load(std::memory_order_relaxed); }
+
+private:
+    enum JobState { FREE, QUEUED, DONE, ABANDONED };
+
+    struct TailJob
+    {
+        std::atomic<int> state{ FREE };
+        std::atomic<juce::int64> index{ -1 }; // Only written while FREE, but the worker reads it in any state
+        std::vector<std::vector<float>> input, output; // [channel][TAIL_SIZE]
+    };
+
+    static constexpr int NUM_JOBS = 4; // Slack for the worker to catch up on a late job
+    static constexpr int POLL_MS = 1;
+    static constexpr int HEADS_PER_TAIL = TAIL_SIZE / HEAD_SIZE;
+    static constexpr int MAX_TAIL_PARTITIONS = (FirDesigner::MAX_LENGTH - FirDesigner::TAIL_OFFSET) / TAIL_SIZE;
+
+    void run() override;
+    void processHeadBlock(int numChannels);
+    void fetchTailBlock(juce::int64 index);
+    void queueTailJob(juce::int64 index);
+
+    // Audio thread
+    PartitionedConvolver _head;
+    TripleBuffer<PartitionedKernel> _head_kernels;
+    std::vector<std::vector<float>> _head_in, _head_out;      // [channel][HEAD_SIZE]
+    std::vector<std::vector<float>> _tail_in, _tail_play;     // [channel][TAIL_SIZE]
+    int _position = 0;                // Samples gathered towards the next head partition
+    juce::int64 _head_blocks = 0;     // Head partitions processed since prepare()
+    int _num_channels = 0;
+
+    std::atomic<juce::int64> _first_tail_job{ 0 }; // Earlier jobs were dropped by reset()
+
+    // Worker thread
+    PartitionedConvolver _tail;
+    TripleBuffer<PartitionedKernel> _tail_kernels;
+    std::atomic<bool> _reset_tail{ false };
+    juce::WaitableEvent _job_done; // Signalled by the worker after each job, for offline fetches
+    bool _prepared = false;        // prepare(), start() and release() are serialised by the caller
+
+    std::array<TailJob, NUM_JOBS> _jobs;
+    std::atomic<juce::uint32> _deadline_misses{ 0 };
+    std::atomic<bool> _non_realtime{ false };
+};
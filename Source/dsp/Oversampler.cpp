@@ -0,0 +1,227 @@
+#include <JuceHeader.h>
+#include <cmath>
+#include <cstring>
+#include "Oversampler.h"
+
+namespace
+{
+    // Nonzero branch taps per stage, first (steepest) first. 48 puts the first stage's
+    // passband edge at about 0.445 of the base rate (19.6 kHz at 44.1 kHz).
+    constexpr int BRANCH_TAPS[] = { 48, 12, 8 };
+
+    // Kaiser window for about 80 dB of image and alias rejection
+    constexpr double KAISER_BETA = 7.9;
+
+    double besselI0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 64 && term > 1.0e-12 * sum; ++k)
+        {
+            const double t = x / (2.0 * k);
+            term *= t * t;
+            sum += term;
+        }
+        return sum;
+    }
+
+    /* The odd-indexed taps of a 4M - 1 tap half-band lowpass (the even ones are zero,
+       bar the 0.5 in the middle), doubled for the upsampler's zero stuffing. Normalised
+       to exactly unity gain at DC. */
+    std::vector<float> designBranch(int numTaps)
+    {
+        const int centre = numTaps - 1;         // Centre of the full filter
+        const double span = 2.0 * numTaps - 2.0; // Full filter length minus one
+
+        std::vector<double> taps((size_t)numTaps);
+        double sum = 0.0;
+        for (int i = 0; i < numTaps; ++i)
+        {
+            const int n = 2 * i;      // Index in the full filter
+            const int k = n - centre; // Odd distance from the centre
+            const double sinc = std::sin(juce::MathConstants<double>::halfPi * k) / (juce::MathConstants<double>::pi * k);
+            const double r = 2.0 * n / span - 1.0;
+            const double window = besselI0(KAISER_BETA * std::sqrt(juce::jmax(0.0, 1.0 - r * r))) / besselI0(KAISER_BETA);
+
+            taps[(size_t)i] = 2.0 * sinc * window;
+            sum += taps[(size_t)i];
+        }
+
+        std::vector<float> result((size_t)numTaps);
+        for (int i = 0; i < numTaps; ++i)
+            result[(size_t)i] = (float)(taps[(size_t)i] / sum);
+        return result;
+    }
+
+    // out[m] = sum over j of taps[j] * in[m + j]: one vectorised pass per tap
+    void branch(const std::vector<float>& taps, const float* in, float* out, int numSamples)
+    {
+        juce::FloatVectorOperations::clear(out, numSamples);
+        for (size_t j = 0; j < taps.size(); ++j)
+            juce::FloatVectorOperations::addWithMultiply(out, in + j, taps[j], numSamples);
+    }
+
+    // Keep the last history samples of a history + block buffer for the next block
+    void keepHistory(std::vector<float>& buffer, int history, int numSamples)
+    {
+        std::memmove(buffer.data(), buffer.data() + numSamples, sizeof(float) * (size_t)history);
+    }
+}
+
+void Oversampler::prepare(int numChannels, int maximumBlockSize, int factor)
+{
+    jassert(factor == 1 || factor == 2 || factor == 4 || factor == MAX_FACTOR);
+
+    _factor = factor;
+    _num_stages = factor >= 8 ? 3 : factor >= 4 ? 2 : factor >= 2 ? 1 : 0;
+    _num_channels = numChannels;
+    _max_block = maximumBlockSize;
+
+    // Round trip of stage s is 2M - 1 samples at its input rate, i.e. (2M - 1) << (stages - s) at the top
+    int topRateLatency = 0;
+    int inputLength = maximumBlockSize;
+    for (int s = 0; s < _num_stages; ++s)
+    {
+        auto& stage = _stages[(size_t)s];
+        stage.taps = designBranch(BRANCH_TAPS[s]);
+        stage.down_taps = stage.taps;
+        juce::FloatVectorOperations::multiply(stage.down_taps.data(), 0.5f, (int)stage.down_taps.size());
+
+        const int history = stage.getHistory();
+        const int numTaps = (int)stage.taps.size();
+        stage.up.assign((size_t)numChannels, std::vector<float>((size_t)(history + inputLength)));
+        stage.down_even.assign((size_t)numChannels, std::vector<float>((size_t)(history + inputLength)));
+        stage.down_odd.assign((size_t)numChannels, std::vector<float>((size_t)(numTaps / 2 + inputLength)));
+
+        topRateLatency += history << (_num_stages - s);
+        inputLength *= 2;
+    }
+
+    _pad = (factor - topRateLatency % factor) % factor;
+    _latency = (topRateLatency + _pad) / factor;
+    _pad_delay.assign((size_t)numChannels, std::vector<float>((size_t)(_pad + maximumBlockSize * factor)));
+
+    _scratch.assign((size_t)(maximumBlockSize * factor / 2 + 1), 0.0f);
+    _upsampled.setSize(numChannels, maximumBlockSize * factor);
+
+    reset();
+}
+
+void Oversampler::reset()
+{
+    for (auto& stage : _stages)
+        for (auto* buffers : { &stage.up, &stage.down_even, &stage.down_odd })
+            for (auto& buffer : *buffers)
+                std::fill(buffer.begin(), buffer.end(), 0.0f);
+
+    for (auto& buffer : _pad_delay)
+        std::fill(buffer.begin(), buffer.end(), 0.0f);
+}
+
+juce::AudioBuffer<float>& Oversampler::processUp(const juce::AudioBuffer<float>& buffer)
+{
+    return processUp(buffer, 0, buffer.getNumSamples());
+}
+
+juce::AudioBuffer<float>& Oversampler::processUp(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    const int numChannels = juce::jmin(_num_channels, buffer.getNumChannels());
+    jassert(numSamples <= _max_block);
+
+    // Never reallocates: it was sized for the largest block in prepare()
+    _upsampled.setSize(_num_channels, numSamples * _factor, false, false, true);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        float* out = _upsampled.getWritePointer(ch);
+        if (_num_stages == 0)
+        {
+            juce::FloatVectorOperations::copy(out, buffer.getReadPointer(ch, startSample), numSamples);
+            continue;
+        }
+
+        auto& first = _stages[0];
+        juce::FloatVectorOperations::copy(first.up[(size_t)ch].data() + first.getHistory(), buffer.getReadPointer(ch, startSample), numSamples);
+
+        int length = numSamples;
+        for (int s = 0; s < _num_stages; ++s)
+        {
+            auto& stage = _stages[(size_t)s];
+            const int history = stage.getHistory();
+            const float* in = stage.up[(size_t)ch].data();
+
+            // Straight into the next stage's input, or the (padded) output
+            float* dst = s + 1 < _num_stages ? _stages[(size_t)s + 1].up[(size_t)ch].data() + _stages[(size_t)s + 1].getHistory()
+                                              : _pad_delay[(size_t)ch].data() + _pad;
+
+            // Even outputs from the branch, odd ones the input delayed by M - 1
+            branch(stage.taps, in, _scratch.data(), length);
+            const float* delayed = in + (history + 1) / 2;
+            for (int m = 0; m < length; ++m)
+            {
+                dst[2 * m] = _scratch[(size_t)m];
+                dst[2 * m + 1] = delayed[m];
+            }
+
+            keepHistory(stage.up[(size_t)ch], history, length);
+            length *= 2;
+        }
+
+        juce::FloatVectorOperations::copy(out, _pad_delay[(size_t)ch].data(), length);
+        keepHistory(_pad_delay[(size_t)ch], _pad, length);
+    }
+
+    for (int ch = numChannels; ch < _num_channels; ++ch)
+        _upsampled.clear(ch, 0, numSamples * _factor);
+
+    return _upsampled;
+}
+
+void Oversampler::processDown(juce::AudioBuffer<float>& buffer)
+{
+    processDown(buffer, 0, buffer.getNumSamples());
+}
+
+void Oversampler::processDown(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    const int numChannels = juce::jmin(_num_channels, buffer.getNumChannels());
+    jassert(numSamples * _factor == _upsampled.getNumSamples());
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        if (_num_stages == 0)
+        {
+            juce::FloatVectorOperations::copy(buffer.getWritePointer(ch, startSample), _upsampled.getReadPointer(ch), numSamples);
+            continue;
+        }
+
+        const float* src = _upsampled.getReadPointer(ch);
+        int length = numSamples * _factor;
+
+        for (int s = _num_stages - 1; s >= 0; --s)
+        {
+            auto& stage = _stages[(size_t)s];
+            const int history = stage.getHistory();
+            const int half = length / 2;
+            const int delay = (history + 1) / 2;
+
+            float* even = stage.down_even[(size_t)ch].data();
+            float* odd = stage.down_odd[(size_t)ch].data();
+            for (int m = 0; m < half; ++m)
+            {
+                even[history + m] = src[2 * m];
+                odd[delay + m] = src[2 * m + 1];
+            }
+
+            // Branch over the even samples plus half of the odd ones delayed by M
+            float* out = s > 0 ? _scratch.data() : buffer.getWritePointer(ch, startSample);
+            branch(stage.down_taps, even, out, half);
+            juce::FloatVectorOperations::addWithMultiply(out, odd, 0.5f, half);
+
+            keepHistory(stage.down_even[(size_t)ch], history, half);
+            keepHistory(stage.down_odd[(size_t)ch], delay, half);
+
+            src = out;
+            length = half;
+        }
+    }
+}
@@ -0,0 +1,68 @@
+/* 2x/4x/8x oversampling around the biquad cascade */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+
+/* Cascaded polyphase half-band FIR stages, each doubling the rate. A half-band filter
+   has every other tap zero except the centre one, so each stage splits into one short
+   FIR branch and one plain delay: upsampling computes the even outputs with the branch
+   and takes the odd ones straight from the input, downsampling does the reverse.
+   The branch is run one tap at a time across the whole block with
+   FloatVectorOperations, so it's vectorised whatever the platform.
+
+   The first stage carries the steep transition just below the base Nyquist; later ones
+   only have to reject images an octave or more away and are much shorter. All stages
+   are linear phase, and a few samples of delay at the top rate make the round trip a
+   whole number of base-rate samples, so the host can compensate it exactly. */
+class Oversampler
+{
+public:
+    static constexpr int MAX_FACTOR = 8;
+
+    // Allocates everything. factor is 1, 2, 4 or 8 (1 makes the rest of the class a no-op).
+    void prepare(int numChannels, int maximumBlockSize, int factor);
+    void reset();
+
+    int getFactor() const { return _factor; }
+    int getMaximumBlockSize() const { return _max_block; }
+
+    // Up and back down, in base-rate samples
+    int getLatencySamples() const { return _latency; }
+
+    // Real-time safe. Upsamples buffer (at most getMaximumBlockSize() samples) into the
+    // internal buffer and returns it, factor times as long, for processing in place.
+    juce::AudioBuffer<float>& processUp(const juce::AudioBuffer<float>& buffer);
+    // The same for numSamples of buffer from startSample on
+    juce::AudioBuffer<float>& processUp(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    // Real-time safe. Brings the internal buffer back down into buffer.
+    void processDown(juce::AudioBuffer<float>& buffer);
+    void processDown(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+private:
+    struct Stage
+    {
+        std::vector<float> taps, down_taps; // Branch taps (symmetric); halved for downsampling
+
+        // Per channel, each with the stage's history in front of the block:
+        // upsampler input, and the even and odd samples of the downsampler input
+        std::vector<std::vector<float>> up, down_even, down_odd;
+
+        int getHistory() const { return (int)taps.size() - 1; }
+    };
+
+    int _factor = 1;
+    int _num_stages = 0;
+    int _num_channels = 0;
+    int _max_block = 0;
+    int _latency = 0;
+
+    std::array<Stage, 3> _stages;
+    int _pad = 0;                          // Top-rate delay to round the latency to whole samples
+    std::vector<std::vector<float>> _pad_delay;
+    std::vector<float> _scratch;
+    juce::AudioBuffer<float> _upsampled;
+};
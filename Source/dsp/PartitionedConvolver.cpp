@@ -0,0 +1,87 @@
+#include <JuceHeader.h>
+#include "PartitionedConvolver.h"
+
+void PartitionedConvolver::prepare(int numChannels, int partitionOrder, int maxPartitions)
+{
+    _partition_order = partitionOrder;
+    _partition_size = 1 << partitionOrder;
+    _max_partitions = juce::jmax(1, maxPartitions);
+    _fft = std::make_unique<juce::dsp::FFT>(partitionOrder + 1);
+
+    _channels.resize((size_t)numChannels);
+    for (auto& c : _channels)
+    {
+        c.input.assign(2 * (size_t)_partition_size, 0.0f);
+        c.fdl.assign((size_t)_max_partitions * (_partition_size + 1), {});
+    }
+
+    _scratch.assign(4 * (size_t)_partition_size, 0.0f);
+    _acc.assign((size_t)_partition_size + 1, {});
+    reset();
+}
+
+void PartitionedConvolver::reset()
+{
+    for (auto& c : _channels)
+    {
+        std::fill(c.input.begin(), c.input.end(), 0.0f);
+        std::fill(c.fdl.begin(), c.fdl.end(), std::complex<float>{});
+        c.fdl_head = 0;
+    }
+}
+
+void PartitionedConvolver::processPartition(int channel, const float* input, float* output, const PartitionedKernel* kernel)
+{
+    auto& c = _channels[(size_t)channel];
+    const int size = _partition_size;
+    const int numBins = size + 1;
+
+    // Slide the input window by one partition and transform it into the delay line
+    std::copy(c.input.begin() + size, c.input.end(), c.input.begin());
+    std::copy_n(input, size, c.input.begin() + size);
+
+    std::copy(c.input.begin(), c.input.end(), _scratch.begin());
+    std::fill(_scratch.begin() + 2 * size, _scratch.end(), 0.0f);
+    _fft->performRealOnlyForwardTransform(_scratch.data(), true);
+
+    c.fdl_head = (c.fdl_head + 1) % _max_partitions;
+    std::copy_n(reinterpret_cast<const std::complex<float>*>(_scratch.data()), numBins,
+                c.fdl.begin() + (size_t)c.fdl_head * numBins);
+
+    if (output == nullptr)
+        return;
+
+    if (kernel == nullptr || kernel->num_partitions == 0 || kernel->partition_order != _partition_order)
+    {
+        std::fill(output, output + size, 0.0f);
+        return;
+    }
+
+    // Multiply-accumulate every kernel partition with the matching past input spectrum.
+    // Split into re/im so the compiler can vectorise the inner loop.
+    std::fill(_acc.begin(), _acc.end(), std::complex<float>{});
+    auto* acc = reinterpret_cast<float*>(_acc.data());
+    const int numPartitions = juce::jmin(kernel->num_partitions, _max_partitions);
+
+    for (int p = 0; p < numPartitions; ++p)
+    {
+        const int slot = (c.fdl_head - p + _max_partitions) % _max_partitions;
+        const auto* x = reinterpret_cast<const float*>(c.fdl.data() + (size_t)slot * numBins);
+        const auto* h = reinterpret_cast<const float*>(kernel->getPartition(p));
+
+        for (int k = 0; k < numBins; ++k)
+        {
+            const float xr = x[2 * k], xi = x[2 * k + 1];
+            const float hr = h[2 * k], hi = h[2 * k + 1];
+            acc[2 * k]     += xr * hr - xi * hi;
+            acc[2 * k + 1] += xr * hi + xi * hr;
+        }
+    }
+
+    // Back to the time domain; overlap-save keeps the second half
+    std::copy_n(acc, 2 * numBins, _scratch.begin());
+    std::fill(_scratch.begin() + 2 * numBins, _scratch.end(), 0.0f);
+    _fft->performRealOnlyInverseTransform(_scratch.data());
+
+    std::copy_n(_scratch.begin() + size, size, output);
+}
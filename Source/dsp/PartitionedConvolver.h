@@ -0,0 +1,46 @@
+/* Uniformly partitioned overlap-save convolution core */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <complex>
+#include <memory>
+#include <vector>
+#include "FirDesigner.h"
+
+/* Every call to processPartition() takes one partition of new input, transforms
+   the newest 2 * partition size samples into a frequency-domain delay line, multiplies
+   it with every kernel partition and transforms back. Buffering host blocks is up
+   to the caller (see NonUniformConvolver). */
+class PartitionedConvolver
+{
+public:
+    // Allocates everything for kernels of up to maxPartitions. Not real-time safe.
+    void prepare(int numChannels, int partitionOrder, int maxPartitions);
+    void reset();
+
+    int getPartitionSize() const { return _partition_size; }
+
+    // output receives the filtered version of the getPartitionSize() samples just passed in.
+    // A null or mismatching kernel outputs silence. A null output only adds the input to the
+    // history, for blocks whose output nobody wants but later blocks still depend on.
+    // Real-time safe.
+    void processPartition(int channel, const float* input, float* output, const PartitionedKernel* kernel);
+
+private:
+    struct Channel
+    {
+        std::vector<float> input;                // Last 2 * partition size samples
+        std::vector<std::complex<float>> fdl;    // _max_partitions spectra, ring buffer
+        int fdl_head = 0;                        // Newest spectrum
+    };
+
+    std::unique_ptr<juce::dsp::FFT> _fft;
+    int _partition_order = 0;
+    int _partition_size = 0;
+    int _max_partitions = 0;
+
+    std::vector<Channel> _channels;
+    std::vector<float> _scratch;                 // 4 * partition size, FFT work area
+    std::vector<std::complex<float>> _acc;       // partition size + 1 bins
+};
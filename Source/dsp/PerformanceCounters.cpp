@@ -0,0 +1,168 @@
+#include <JuceHeader.h>
+#include <algorithm>
+#include <cstring>
+#include "PerformanceCounters.h"
+
+void PerformanceCounters::Snapshot::writeBinary(juce::OutputStream& out) const
+{
+    for (const auto count : histogram)
+        out.writeInt64((juce::int64)count);
+
+    out.writeInt64((juce::int64)num_blocks);
+    out.writeInt64((juce::int64)busy_ns);
+    out.writeInt64((juce::int64)budget_ns);
+    out.writeFloat(max_block_us);
+    out.writeFloat(max_utilisation);
+    out.writeInt64((juce::int64)non_finite_in);
+    out.writeInt64((juce::int64)non_finite_out);
+    out.writeInt64((juce::int64)denormal_in);
+    out.writeInt64((juce::int64)denormal_out);
+    out.writeInt64((juce::int64)state_flushes);
+    out.writeInt64((juce::int64)state_resets);
+    out.writeInt64((juce::int64)sections_replaced);
+}
+
+void PerformanceCounters::prepare(double sampleRate)
+{
+    _ns_per_sample = 1.0e9 / sampleRate;
+
+    for (auto& bucket : _histogram)
+        bucket = 0;
+    for (auto* counter : { &_num_blocks, &_busy_ns, &_budget_ns, &_non_finite_in, &_non_finite_out, &_denormal_in, &_denormal_out,
+                           &_state_flushes, &_state_resets, &_sections_replaced })
+        *counter = 0;
+    for (auto* value : { &_max_block_us, &_max_utilisation, &_closed_peak })
+        *value = 0.0f;
+    _window_peak = 0.0f;
+}
+
+void PerformanceCounters::beginBlock(const juce::AudioBuffer<float>& input)
+{
+    const auto findings = scan(input);
+    if (findings.non_finite)
+        increment(_non_finite_in);
+    if (findings.denormal)
+        increment(_denormal_in);
+
+    _start_ticks = juce::Time::getHighResolutionTicks();
+}
+
+void PerformanceCounters::endBlock(const juce::AudioBuffer<float>& output)
+{
+    const double busyNs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - _start_ticks) * 1.0e9;
+
+    const auto findings = scan(output);
+    if (findings.non_finite)
+        increment(_non_finite_out);
+    if (findings.denormal)
+        increment(_denormal_out);
+
+    const int numSamples = output.getNumSamples();
+    if (numSamples == 0)
+        return;
+
+    const double budgetNs = numSamples * _ns_per_sample;
+    const auto utilisation = (float)(busyNs / budgetNs);
+
+    int bucket = 0;
+    while (bucket < NUM_BUCKETS - 1 && utilisation >= BUCKET_EDGES[(size_t)bucket])
+        ++bucket;
+
+    increment(_histogram[(size_t)bucket]);
+    increment(_num_blocks);
+    increment(_busy_ns, (juce::uint64)busyNs);
+    increment(_budget_ns, (juce::uint64)budgetNs);
+    raise(_max_block_us, (float)(busyNs / 1000.0));
+    raise(_max_utilisation, utilisation);
+
+    // This block starts the next window if the meter has asked for one
+    const auto request = _peak_request.load(std::memory_order_relaxed);
+    if (request != _peak_window)
+    {
+        _closed_peak.store(_window_peak, std::memory_order_relaxed);
+        _peak_closed.store(request, std::memory_order_release);
+        _peak_window = request;
+        _window_peak = 0.0f;
+    }
+    _window_peak = juce::jmax(_window_peak, utilisation);
+}
+
+float PerformanceCounters::takePeakUtilisation()
+{
+    if (_peak_closed.load(std::memory_order_acquire) == _peak_requested)
+    {
+        _last_peak = _closed_peak.load(std::memory_order_relaxed);
+        _peak_request.store(++_peak_requested, std::memory_order_relaxed);
+    }
+    return _last_peak;
+}
+
+void PerformanceCounters::countRepairs(const FilterHealth::Repairs& repairs)
+{
+    if (! repairs.any())
+        return;
+
+    increment(_state_flushes, (juce::uint64)repairs.flushed);
+    increment(_state_resets, (juce::uint64)repairs.reset);
+    increment(_sections_replaced, (juce::uint64)repairs.replaced);
+}
+
+PerformanceCounters::Snapshot PerformanceCounters::getSnapshot() const
+{
+    Snapshot snapshot;
+    for (size_t b = 0; b < _histogram.size(); ++b)
+        snapshot.histogram[b] = _histogram[b].load(std::memory_order_relaxed);
+
+    snapshot.num_blocks = _num_blocks.load(std::memory_order_relaxed);
+    snapshot.busy_ns = _busy_ns.load(std::memory_order_relaxed);
+    snapshot.budget_ns = _budget_ns.load(std::memory_order_relaxed);
+    snapshot.max_block_us = _max_block_us.load(std::memory_order_relaxed);
+    snapshot.max_utilisation = _max_utilisation.load(std::memory_order_relaxed);
+    snapshot.non_finite_in = _non_finite_in.load(std::memory_order_relaxed);
+    snapshot.non_finite_out = _non_finite_out.load(std::memory_order_relaxed);
+    snapshot.denormal_in = _denormal_in.load(std::memory_order_relaxed);
+    snapshot.denormal_out = _denormal_out.load(std::memory_order_relaxed);
+    snapshot.state_flushes = _state_flushes.load(std::memory_order_relaxed);
+    snapshot.state_resets = _state_resets.load(std::memory_order_relaxed);
+    snapshot.sections_replaced = _sections_replaced.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+PerformanceCounters::Findings PerformanceCounters::scan(const juce::AudioBuffer<float>& buffer)
+{
+    // Works on the bits, since with DAZ on (ScopedNoDenormals) float compares see denormals
+    // as zero. With the sign cleared, NaN and Inf are the values from EXPONENT up, and
+    // denormals those from 1 to MANTISSA, so a running max and min find both. They're kept
+    // per lane so the compiler can turn each group of LANES samples into vector min / max.
+    constexpr juce::uint32 ABS = 0x7fffffff, EXPONENT = 0x7f800000, MANTISSA = 0x007fffff;
+    constexpr int LANES = 8;
+
+    std::array<juce::uint32, LANES> highest{}, lowestNonZero{};
+    lowestNonZero.fill(~0u);
+
+    const auto accumulate = [&](const float* data, int lane)
+    {
+        juce::uint32 bits;
+        std::memcpy(&bits, data, sizeof(bits));
+        bits &= ABS;
+        highest[(size_t)lane] = bits > highest[(size_t)lane] ? bits : highest[(size_t)lane];
+        bits -= 1; // Zero wraps round to the top
+        lowestNonZero[(size_t)lane] = bits < lowestNonZero[(size_t)lane] ? bits : lowestNonZero[(size_t)lane];
+    };
+
+    const int numSamples = buffer.getNumSamples();
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+    {
+        const float* data = buffer.getReadPointer(ch);
+        int i = 0;
+        for (; i + LANES <= numSamples; i += LANES)
+            for (int lane = 0; lane < LANES; ++lane)
+                accumulate(data + i + lane, lane);
+        for (; i < numSamples; ++i)
+            accumulate(data + i, 0);
+    }
+
+    const auto high = *std::max_element(highest.begin(), highest.end());
+    const auto low = *std::min_element(lowestNonZero.begin(), lowestNonZero.end());
+    return { high >= EXPONENT, low < MANTISSA };
+}
@@ -0,0 +1,110 @@
+/* Lock-free health counters for one processor instance */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "FilterHealth.h"
+
+/* processBlock brackets its work with beginBlock() and endBlock(). They time it against
+   the block's duration and check the audio going in and coming out for NaN / Inf and
+   denormal samples, so a glitching session can be traced to the instance that caused
+   it, and whether the bad samples came from upstream. countRepairs() adds what the
+   engines' once-a-block state checks fixed (see FilterHealth).
+
+   The audio thread is the only writer of the counters, so it updates them with relaxed
+   loads and stores (no read-modify-write). Any thread can take a snapshot; its fields
+   are each consistent but may be a block apart from one another. The meter's peak is
+   kept in windows the audio thread closes when the meter asks for a new one, so the
+   meter writes nothing but its request. */
+class PerformanceCounters
+{
+public:
+    // Block time as a share of the block's duration. Bucket b counts blocks under
+    // BUCKET_EDGES[b]; the last bucket is blocks that overran their duration.
+    static constexpr int NUM_BUCKETS = 8;
+    static constexpr std::array<float, NUM_BUCKETS - 1> BUCKET_EDGES{ 0.01f, 0.02f, 0.05f, 0.1f, 0.2f, 0.5f, 1.0f };
+
+    struct Snapshot
+    {
+        std::array<juce::uint64, NUM_BUCKETS> histogram{};
+        juce::uint64 num_blocks = 0;
+        juce::uint64 busy_ns = 0, budget_ns = 0; // Total processing time, and the audio's duration
+        float max_block_us = 0.0f;
+        float max_utilisation = 0.0f;            // Worst block, as a share of its duration
+        juce::uint64 non_finite_in = 0, non_finite_out = 0; // Blocks with NaN / Inf samples
+        juce::uint64 denormal_in = 0, denormal_out = 0;     // Blocks with denormal samples
+        juce::uint64 state_flushes = 0;     // Filter sections with denormal state flushed to zero
+        juce::uint64 state_resets = 0;      // ... and with NaN / Inf state reset to silence
+        juce::uint64 sections_replaced = 0; // Unstable or non-finite sections run as identity
+
+        juce::uint64 getNumOverruns() const { return histogram[NUM_BUCKETS - 1]; }
+
+        // Every field in declaration order, little-endian, for dumping with the plugin state
+        static constexpr int BINARY_SIZE = (NUM_BUCKETS + 10) * 8 + 2 * 4;
+        void writeBinary(juce::OutputStream& out) const;
+    };
+
+    // Not real-time safe. Clears everything.
+    void prepare(double sampleRate);
+
+    //==========================
+    // Audio thread. Real-time safe.
+
+    void beginBlock(const juce::AudioBuffer<float>& input);
+    void endBlock(const juce::AudioBuffer<float>& output);
+
+    // A branch per block when there's nothing to count
+    void countRepairs(const FilterHealth::Repairs& repairs);
+
+    //==========================
+    // Any thread
+
+    Snapshot getSnapshot() const;
+
+    // Worst utilisation over the last closed window, and asks for the next. A window closes
+    // at the first block after the request, so until one does this returns the last peak
+    // again. One caller at a time (the editor's meter).
+    float takePeakUtilisation();
+
+private:
+    struct Findings
+    {
+        bool non_finite = false;
+        bool denormal = false;
+    };
+
+    static Findings scan(const juce::AudioBuffer<float>& buffer);
+
+    template <typename T>
+    static void increment(std::atomic<T>& counter, T amount = 1)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    static void raise(std::atomic<T>& counter, T value)
+    {
+        if (value > counter.load(std::memory_order_relaxed))
+            counter.store(value, std::memory_order_relaxed);
+    }
+
+    double _ns_per_sample = 1.0e9 / 44100.0;
+    juce::int64 _start_ticks = 0; // Audio thread only
+
+    std::array<std::atomic<juce::uint64>, NUM_BUCKETS> _histogram{};
+    std::atomic<juce::uint64> _num_blocks{ 0 }, _busy_ns{ 0 }, _budget_ns{ 0 };
+    std::atomic<float> _max_block_us{ 0.0f }, _max_utilisation{ 0.0f };
+    std::atomic<juce::uint64> _non_finite_in{ 0 }, _non_finite_out{ 0 }, _denormal_in{ 0 }, _denormal_out{ 0 };
+    std::atomic<juce::uint64> _state_flushes{ 0 }, _state_resets{ 0 }, _sections_replaced{ 0 };
+
+    // Peak windows. The meter bumps _peak_request; the audio thread, seeing it, publishes
+    // the window's peak and then the request it answered in _peak_closed.
+    std::atomic<juce::uint32> _peak_request{ 0 }, _peak_closed{ 0 };
+    std::atomic<float> _closed_peak{ 0.0f };
+    juce::uint32 _peak_window = 0; // Audio thread only: the request the open window answers
+    float _window_peak = 0.0f;     // ... and its peak so far
+    juce::uint32 _peak_requested = 0; // The meter's only
+    float _last_peak = 0.0f;          // ... likewise
+};
@@ -0,0 +1,146 @@
+#include <JuceHeader.h>
+#include <cmath>
+#include <cstring>
+#include "ResponseCache.h"
+
+void ResponseCache::setFrequencies(const std::vector<float>& frequencies, double sampleRate)
+{
+    _sample_rate = sampleRate;
+
+    const size_t n = frequencies.size();
+    _phi.resize(n);
+    _phi_squared.resize(n);
+    _product.resize(n);
+    _db.assign(n, 0.0f);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const double w = juce::MathConstants<double>::twoPi * juce::jlimit(0.0, sampleRate * 0.5, (double)frequencies[i]) / sampleRate;
+        const double s = std::sin(0.5 * w);
+        _phi[i] = (float)(s * s);
+        _phi_squared[i] = (float)(s * s * s * s);
+    }
+
+    _row_valid.fill(false);
+    _row_of_key.clear();
+}
+
+std::size_t ResponseCache::SectionKeyHash::operator()(const SectionKey& key) const
+{
+    std::size_t hash = 0;
+    for (const auto word : key.bits)
+        hash = hash * 0x9e3779b97f4a7c15ull + word;
+    return hash ^ (hash >> 29);
+}
+
+ResponseCache::SectionKey ResponseCache::getKey(const CoefficientBank& bank, int s)
+{
+    SectionKey key;
+    const float coefficients[] = { bank.b0[s], bank.b1[s], bank.b2[s], bank.a1[s], bank.a2[s] };
+    std::memcpy(key.bits.data(), coefficients, sizeof(coefficients));
+    return key;
+}
+
+int ResponseCache::update(const CoefficientBank& bank)
+{
+    const int numSections = bank.num_sections;
+    const int n = getNumFrequencies();
+    if (n == 0)
+        return 0;
+
+    // First every section that already has a row, so none of those gets overwritten
+    _row_used.fill(false);
+    for (int s = 0; s < numSections; ++s)
+    {
+        const auto found = _row_of_key.find(getKey(bank, s));
+        _section_rows[s] = found != _row_of_key.end() ? found->second : -1;
+        if (found != _row_of_key.end())
+            _row_used[found->second] = true;
+    }
+
+    // Then the new ones, into rows no section uses. There's always one: at most
+    // numSections rows are used, and there are as many rows as sections can be.
+    int evaluated = 0;
+    for (int s = 0; s < numSections; ++s)
+    {
+        if (_section_rows[s] >= 0)
+            continue;
+
+        const auto key = getKey(bank, s);
+        const auto found = _row_of_key.find(key); // An earlier new section may have been the same
+        if (found != _row_of_key.end())
+        {
+            _section_rows[s] = found->second;
+            continue;
+        }
+
+        const int row = findFreeRow();
+        if (_row_valid[row])
+            _row_of_key.erase(_row_keys[row]);
+
+        evaluateSection(bank, s, row);
+        _row_keys[row] = key;
+        _row_of_key[key] = row;
+        _row_used[row] = true;
+        _section_rows[s] = row;
+        ++evaluated;
+    }
+
+    // Rows no section uses stay cached (they're likely to come back when a dot is re-added)
+    // but are no longer part of the response
+    std::fill(_product.begin(), _product.end(), 1.0f);
+    for (int s = 0; s < numSections; ++s)
+        juce::FloatVectorOperations::multiply(_product.data(), _rows.data() + (size_t)_section_rows[s] * n, n);
+
+    for (int i = 0; i < n; ++i)
+        _db[i] = 10.0f * std::log10(juce::jmax(_product[i], 1.0e-30f));
+
+    return evaluated;
+}
+
+int ResponseCache::findFreeRow() const
+{
+    // Empty rows first, then stale ones
+    for (int row = 0; row < NUM_ROWS; ++row)
+        if (! _row_valid[row])
+            return row;
+
+    for (int row = 0; row < NUM_ROWS; ++row)
+        if (! _row_used[row])
+            return row;
+
+    jassertfalse;
+    return 0;
+}
+
+void ResponseCache::evaluateSection(const CoefficientBank& bank, int s, int r)
+{
+    _row_valid[r] = true;
+
+    const int n = getNumFrequencies();
+    if (_rows.size() < (size_t)(r + 1) * n)
+        _rows.resize((size_t)(r + 1) * n);
+
+    // |H|^2 as polynomials in phi = sin^2(w / 2). Unlike the cos w form, this doesn't
+    // cancel catastrophically at low frequencies in single precision.
+    const double b0 = bank.b0[s], b1 = bank.b1[s], b2 = bank.b2[s];
+    const double a1 = bank.a1[s], a2 = bank.a2[s];
+
+    const float n0 = (float)((b0 + b1 + b2) * (b0 + b1 + b2));
+    const float n1 = (float)(-4.0 * (b0 * b1 + 4.0 * b0 * b2 + b1 * b2));
+    const float n2 = (float)(16.0 * b0 * b2);
+    const float d0 = (float)((1.0 + a1 + a2) * (1.0 + a1 + a2));
+    const float d1 = (float)(-4.0 * (a1 + 4.0 * a2 + a1 * a2));
+    const float d2 = (float)(16.0 * a2);
+
+    const float* phi = _phi.data();
+    const float* phi2 = _phi_squared.data();
+    float* row = _rows.data() + (size_t)r * n;
+
+    for (int i = 0; i < n; ++i)
+    {
+        const float num = n0 + n1 * phi[i] + n2 * phi2[i];
+        const float den = d0 + d1 * phi[i] + d2 * phi2[i];
+        row[i] = juce::jmax(num, 1.0e-30f) / juce::jmax(den, 1.0e-30f);
+    }
+}
@@ -0,0 +1,68 @@
+/* Cached magnitude response of a biquad cascade, for drawing */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "CurveDesigner.h"
+
+/* Evaluates a CoefficientBank at a fixed set of frequencies (one per pixel column of
+   the graph). Each section's |H|^2 is kept as a row, keyed by the section's exact
+   coefficients rather than its index, so update() only evaluates sections it hasn't
+   seen: a section that moved to another index (a dot inserted before it, the
+   breakpoint bands after a curve with one dot more) keeps its row, and identical
+   sections share one. The rows are then multiplied together and turned into dB once
+   per frequency. All the per-frequency loops are straight-line and branch-free over
+   contiguous floats, so they vectorise.
+
+   CurveDesigner's gain correction touches every section of the curve on any edit, if
+   only in the last few bits, so those are all evaluated again each time; what's
+   saved is everything the edit didn't design (the breakpoint bands, a slot switched
+   back to). No tolerance is applied: skipped small changes would add up across
+   hundreds of sections. */
+class ResponseCache
+{
+public:
+    // Invalidates every row. Not cheap: do it on resize, not per edit.
+    void setFrequencies(const std::vector<float>& frequencies, double sampleRate);
+
+    // Brings the cached response in line with bank. Returns the number of sections evaluated.
+    int update(const CoefficientBank& bank);
+
+    // Response in dB at each frequency passed to setFrequencies()
+    const std::vector<float>& getMagnitudeDb() const { return _db; }
+    int getNumFrequencies() const { return (int)_phi.size(); }
+    double getSampleRate() const { return _sample_rate; }
+
+private:
+    static constexpr int NUM_ROWS = CoefficientBank::MAX_SECTIONS;
+
+    // A section's coefficients, bit for bit
+    struct SectionKey
+    {
+        std::array<std::uint32_t, 5> bits{};
+
+        bool operator==(const SectionKey& other) const { return bits == other.bits; }
+    };
+    struct SectionKeyHash
+    {
+        std::size_t operator()(const SectionKey& key) const;
+    };
+
+    static SectionKey getKey(const CoefficientBank& bank, int section);
+    int findFreeRow() const;
+    void evaluateSection(const CoefficientBank& bank, int section, int row);
+
+    double _sample_rate = 0.0;
+    std::vector<float> _phi, _phi_squared; // sin^2(w / 2), and its square, per frequency
+
+    std::vector<float> _rows; // [row * num frequencies + i], |H(w_i)|^2 of the section in that row
+    std::unordered_map<SectionKey, int, SectionKeyHash> _row_of_key;
+    std::array<SectionKey, NUM_ROWS> _row_keys;
+    std::array<bool, NUM_ROWS> _row_valid{}, _row_used{}; // Used: by a section of the bank being updated
+    std::array<int, CoefficientBank::MAX_SECTIONS> _section_rows{};
+
+    std::vector<float> _product, _db;
+};
@@ -0,0 +1,170 @@
+#include <JuceHeader.h>
+#include <cmath>
+#include "SpectrumAnalyzer.h"
+
+SpectrumAnalyzer::SpectrumAnalyzer()
+    : _fifo_data((size_t)FIFO_SIZE, 0.0f)
+{
+    allocate();
+}
+
+void SpectrumAnalyzer::push(const juce::AudioBuffer<float>& buffer)
+{
+    if (! _enabled.load(std::memory_order_relaxed))
+        return;
+
+    const int numChannels = buffer.getNumChannels();
+    const int numSamples = juce::jmin(buffer.getNumSamples(), _fifo.getFreeSpace());
+    if (numChannels == 0 || numSamples == 0)
+        return;
+
+    int start1, size1, start2, size2;
+    _fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+    // Mono sum straight into the FIFO's storage
+    const float gain = 1.0f / (float)numChannels;
+    auto mix = [&](int destStart, int sourceStart, int count)
+    {
+        float* dest = _fifo_data.data() + destStart;
+        juce::FloatVectorOperations::copy(dest, buffer.getReadPointer(0, sourceStart), count);
+        for (int ch = 1; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::add(dest, buffer.getReadPointer(ch, sourceStart), count);
+        juce::FloatVectorOperations::multiply(dest, gain, count);
+    };
+
+    if (size1 > 0)
+        mix(start1, 0, size1);
+    if (size2 > 0)
+        mix(start2, size1, size2);
+
+    _fifo.finishedWrite(size1 + size2);
+}
+
+//==========================
+
+void SpectrumAnalyzer::setEnabled(bool shouldBeEnabled)
+{
+    if (shouldBeEnabled == isEnabled())
+        return;
+
+    if (shouldBeEnabled)
+    {
+        // Whatever's left in the FIFO is from before we were last switched off
+        _fifo.finishedRead(_fifo.getNumReady());
+        allocate();
+    }
+
+    _enabled = shouldBeEnabled;
+}
+
+void SpectrumAnalyzer::setFftOrder(int order)
+{
+    order = juce::jlimit(MIN_ORDER, MAX_ORDER, order);
+    if (order == _order)
+        return;
+
+    _order = order;
+    allocate();
+}
+
+void SpectrumAnalyzer::setOverlap(int overlap)
+{
+    _overlap = juce::jlimit(1, 8, overlap);
+}
+
+void SpectrumAnalyzer::allocate()
+{
+    const int size = getFftSize();
+    const int numBins = size / 2 + 1;
+
+    _fft = std::make_unique<juce::dsp::FFT>(_order);
+    _history.assign((size_t)size, 0.0f);
+    _work.assign((size_t)size * 2, 0.0f);
+    _average.assign((size_t)numBins, 0.0f);
+    _average_db.assign((size_t)numBins, -100.0f);
+    _peak_db.assign((size_t)numBins, -100.0f);
+    _since_last_fft = 0;
+
+    // Hann, scaled so a full-scale sine on a bin centre reads 0 dB
+    _window.resize((size_t)size);
+    float sum = 0.0f;
+    for (int i = 0; i < size; ++i)
+    {
+        _window[(size_t)i] = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * (float)i / (float)size);
+        sum += _window[(size_t)i];
+    }
+
+    juce::FloatVectorOperations::multiply(_window.data(), 2.0f / sum, size);
+}
+
+bool SpectrumAnalyzer::process(double sampleRate)
+{
+    if (! isEnabled() || sampleRate <= 0.0)
+        return false;
+
+    const int size = getFftSize();
+    const int hop = size / _overlap;
+
+    // If we've fallen a long way behind (the editor was hidden, say), only the newest
+    // FFT size worth of samples is worth analysing
+    int ready = _fifo.getNumReady();
+    if (ready > size + hop)
+    {
+        _fifo.finishedRead(ready - size);
+        ready = size;
+    }
+
+    bool changed = false;
+    while (ready > 0)
+    {
+        const int count = juce::jmin(ready, hop - _since_last_fft);
+
+        int start1, size1, start2, size2;
+        _fifo.prepareToRead(count, start1, size1, start2, size2);
+
+        // Slide the history along and append the new samples
+        std::move(_history.begin() + count, _history.end(), _history.begin());
+        std::copy_n(_fifo_data.begin() + start1, size1, _history.end() - count);
+        std::copy_n(_fifo_data.begin() + start2, size2, _history.end() - count + size1);
+        _fifo.finishedRead(size1 + size2);
+
+        ready -= count;
+        _since_last_fft += count;
+
+        if (_since_last_fft == hop)
+        {
+            runFft(sampleRate);
+            _since_last_fft = 0;
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+
+void SpectrumAnalyzer::runFft(double sampleRate)
+{
+    const int size = getFftSize();
+    const int numBins = size / 2 + 1;
+
+    std::fill(_work.begin(), _work.end(), 0.0f);
+    for (int i = 0; i < size; ++i)
+        _work[(size_t)i] = _history[(size_t)i] * _window[(size_t)i];
+
+    _fft->performFrequencyOnlyForwardTransform(_work.data(), true);
+
+    // Peak hold falls at a fixed rate in dB per second, whatever the hop
+    const float hopSeconds = (float)(size / _overlap / sampleRate);
+    const float peakFall = _peak_decay_db * hopSeconds;
+
+    for (int k = 0; k < numBins; ++k)
+    {
+        const float power = _work[(size_t)k] * _work[(size_t)k];
+        auto& average = _average[(size_t)k];
+        average = _smoothing * average + (1.0f - _smoothing) * power;
+
+        const float db = 10.0f * std::log10(juce::jmax(average, 1.0e-10f));
+        _average_db[(size_t)k] = db;
+        _peak_db[(size_t)k] = juce::jmax(db, _peak_db[(size_t)k] - peakFall);
+    }
+}
@@ -0,0 +1,76 @@
+/* Spectrum analyzer fed from the audio thread through a wait-free FIFO */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/* processBlock calls push() with the block it wants analysed: it mixes the channels
+   down to mono into an AbstractFifo and never blocks; if the FIFO is full the samples
+   are dropped. Everything else happens on the message thread: process() drains the
+   FIFO and runs a Hann-windowed FFT every hop (FFT size / overlap), then smooths the
+   power spectrum exponentially and keeps a decaying peak hold.
+
+   While disabled (no editor open) push() returns straight away. */
+class SpectrumAnalyzer
+{
+public:
+    static constexpr int FIFO_SIZE = 1 << 15;
+    static constexpr int MIN_ORDER = 9;
+    static constexpr int MAX_ORDER = 14;
+
+    SpectrumAnalyzer();
+
+    //==========================
+    // Audio thread
+
+    // Real-time safe and wait-free
+    void push(const juce::AudioBuffer<float>& buffer);
+
+    //==========================
+    // Message thread
+
+    void setEnabled(bool shouldBeEnabled);
+    bool isEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+    // FFT size is 2^order, clamped to [MIN_ORDER, MAX_ORDER]. Resets the averages.
+    void setFftOrder(int order);
+    // FFTs per FFT length: 1 (none) up to 8
+    void setOverlap(int overlap);
+    // Weight of the previous average, 0 (none) to just under 1
+    void setAveraging(float smoothing) { _smoothing = juce::jlimit(0.0f, 0.99f, smoothing); }
+    void setPeakDecay(float decibelsPerSecond) { _peak_decay_db = juce::jmax(0.0f, decibelsPerSecond); }
+
+    // Runs every FFT that's due. Returns true if the spectrum changed.
+    bool process(double sampleRate);
+
+    int getFftSize() const { return 1 << _order; }
+    // getFftSize() / 2 + 1 bins, in dB relative to a full-scale sine
+    const std::vector<float>& getSpectrumDb() const { return _average_db; }
+    const std::vector<float>& getPeakDb() const { return _peak_db; }
+
+private:
+    void allocate();
+    void runFft(double sampleRate);
+
+    // Shared
+    juce::AbstractFifo _fifo{ FIFO_SIZE };
+    std::vector<float> _fifo_data;
+    std::atomic<bool> _enabled{ false };
+
+    // Message thread
+    int _order = 12;
+    int _overlap = 4;
+    float _smoothing = 0.8f;
+    float _peak_decay_db = 20.0f;
+
+    std::unique_ptr<juce::dsp::FFT> _fft;
+    std::vector<float> _window;
+    std::vector<float> _history;  // Last FFT size samples, oldest first
+    std::vector<float> _work;     // 2 * FFT size, as performFrequencyOnlyForwardTransform wants
+    std::vector<float> _average;  // Smoothed power per bin
+    std::vector<float> _average_db, _peak_db;
+    int _since_last_fft = 0;
+};
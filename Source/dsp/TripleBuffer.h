@@ -0,0 +1,57 @@
+/* Wait-free single-producer / single-consumer handoff of a whole object */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+/* Three preallocated copies of T: the writer fills its private slot and swaps it
+   into the shared middle slot, the reader swaps the middle slot out when it holds
+   something new. Neither side ever waits, allocates or sees a half-written object,
+   and the writer can publish as often as it likes (intermediate values are dropped).
+
+   Exactly one writer thread and one reader thread. */
+template <typename T>
+class TripleBuffer
+{
+public:
+    //==========================
+    // Writer side
+
+    // The slot to fill before calling publish(). Owned by the writer until then.
+    T& getWriteBuffer() { return _buffers[_write_idx]; }
+
+    void publish()
+    {
+        const int previous = _middle.exchange(_write_idx | NEW_DATA, std::memory_order_acq_rel);
+        _write_idx = previous & INDEX_MASK;
+    }
+
+    //==========================
+    // Reader side
+
+    // Grabs the latest published object if there is one. Returns true if the read buffer changed.
+    bool update()
+    {
+        if ((_middle.load(std::memory_order_relaxed) & NEW_DATA) == 0)
+            return false;
+
+        const int previous = _middle.exchange(_read_idx, std::memory_order_acq_rel);
+        _read_idx = previous & INDEX_MASK;
+        return true;
+    }
+
+    // Stays valid and unchanged until the next call to update()
+    const T& getReadBuffer() const { return _buffers[_read_idx]; }
+
+private:
+    static constexpr int INDEX_MASK = 0x3;
+    static constexpr int NEW_DATA = 0x4;
+
+    std::array<T, 3> _buffers{};
+
+    // Each index on its own cache line so the two threads don't false-share
+    alignas(64) int _write_idx = 0;
+    alignas(64) std::atomic<int> _middle{ 1 };
+    alignas(64) int _read_idx = 2;
+};
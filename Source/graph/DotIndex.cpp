@@ -0,0 +1,84 @@
+#include <JuceHeader.h>
+#include <algorithm>
+#include "DotIndex.h"
+
+int DotIndex::findDot(juce::Point<float> p, float radius) const
+{
+    // Only dots within radius horizontally can be hit
+    auto it = std::lower_bound(_points.begin(), _points.end(), p.x - radius,
+        [](const juce::Point<float>& point, float x) { return point.x < x; });
+
+    int nearest = -1;
+    float nearestDistance = radius;
+
+    for (; it != _points.end() && it->x <= p.x + radius; ++it)
+    {
+        const float distance = p.getDistanceFrom(*it);
+        if (distance <= nearestDistance)
+        {
+            nearestDistance = distance;
+            nearest = (int)std::distance(_points.begin(), it);
+        }
+    }
+
+    return nearest;
+}
+
+int DotIndex::findSegment(juce::Point<float> p) const
+{
+    const int numSegments = size() - 1;
+    if (numSegments < 1)
+        return -1;
+
+    // Start from the segment spanning p.x and work outwards. A segment can't be closer
+    // than its horizontal gap to p, and the gaps only grow from here in both directions.
+    auto it = std::upper_bound(_points.begin(), _points.end(), p.x,
+        [](float x, const juce::Point<float>& point) { return x < point.x; });
+    const int start = juce::jlimit(0, numSegments - 1, (int)std::distance(_points.begin(), it) - 1);
+
+    auto gap = [&](int segment)
+    {
+        return juce::jmax(0.0f, _points[(size_t)segment].x - p.x, p.x - _points[(size_t)segment + 1].x);
+    };
+
+    int closest = start;
+    float closestDistance = distanceToSegment(_points[(size_t)start], _points[(size_t)start + 1], p);
+
+    for (int i = start - 1; i >= 0 && gap(i) < closestDistance; --i)
+    {
+        const float distance = distanceToSegment(_points[(size_t)i], _points[(size_t)i + 1], p);
+        if (distance < closestDistance)
+        {
+            closestDistance = distance;
+            closest = i;
+        }
+    }
+
+    for (int i = start + 1; i < numSegments && gap(i) < closestDistance; ++i)
+    {
+        const float distance = distanceToSegment(_points[(size_t)i], _points[(size_t)i + 1], p);
+        if (distance < closestDistance)
+        {
+            closestDistance = distance;
+            closest = i;
+        }
+    }
+
+    return closest;
+}
+
+float DotIndex::distanceToSegment(juce::Point<float> p1, juce::Point<float> p2, juce::Point<float> p)
+{
+    auto d = p2 - p1;
+    float lenSquared = d.x * d.x + d.y * d.y; // Squared length of the line segment
+
+    if (lenSquared == 0.0f)
+        return p.getDistanceFrom(p1); // If the line segment is a point, return distance to p1
+
+    // Project the point onto the line segment and clamp to the segment
+    auto t = ((p.x - p1.x) * d.x + (p.y - p1.y) * d.y) / lenSquared;
+    t = juce::jlimit(0.0f, 1.0f, t);
+
+    // Return the distance from the point to the projection
+    return p.getDistanceFrom(p1 + d * t);
+}
@@ -0,0 +1,34 @@
+/* Screen-space index over the graph's dots for hit testing */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+/* Screen positions of the dots, in dot order. Dots are sorted by frequency, so the
+   positions are sorted by x, and a binary search on x narrows any query down to the
+   few dots or segments near the mouse: hit tests and nearest-segment lookups are
+   O(log n) plus whatever is within reach, instead of a log10 per dot.
+   Rebuilt on resize and when the whole curve is replaced; single edits are patched in. */
+class DotIndex
+{
+public:
+    void rebuild(std::vector<juce::Point<float>> points) { _points = std::move(points); }
+    // The caller keeps x in order (a dragged dot is clamped between its neighbours)
+    void move(int index, juce::Point<float> point) { _points[(size_t)index] = point; }
+    void insert(int index, juce::Point<float> point) { _points.insert(_points.begin() + index, point); }
+
+    int size() const { return (int)_points.size(); }
+    juce::Point<float> getPoint(int index) const { return _points[(size_t)index]; }
+
+    // Nearest dot within radius of p, or -1
+    int findDot(juce::Point<float> p, float radius) const;
+
+    // i for the segment from dot i to dot i + 1 closest to p, or -1 with fewer than two dots
+    int findSegment(juce::Point<float> p) const;
+
+    static float distanceToSegment(juce::Point<float> p1, juce::Point<float> p2, juce::Point<float> p);
+
+private:
+    std::vector<juce::Point<float>> _points;
+};
@@ -1,39 +1,190 @@
 #include "graphCmp.h"
 
+namespace
+{
+    // Choices offered for each dynamics setting
+    const float THRESHOLDS_DB[] = { -48.0f, -42.0f, -36.0f, -30.0f, -24.0f, -18.0f, -12.0f, -6.0f };
+    const float RATIOS[] = { 1.5f, 2.0f, 3.0f, 4.0f, 8.0f, 20.0f };
+    const float ATTACKS_MS[] = { 1.0f, 3.0f, 10.0f, 30.0f, 100.0f };
+    const float RELEASES_MS[] = { 30.0f, 80.0f, 150.0f, 300.0f, 1000.0f };
+    const float BAND_QS[] = { 0.5f, 0.7071f, 1.0f, 2.0f, 4.0f, 8.0f };
+
+    // Menu item IDs: one range per setting, offset by the choice's index
+    enum MenuIds { TOGGLE_ID = 1, THRESHOLD_ID = 100, RATIO_ID = 200, ATTACK_ID = 300, RELEASE_ID = 400, Q_ID = 500 };
+
+    template <size_t N>
+    juce::PopupMenu makeChoices(int firstId, const float (&values)[N], float current, const juce::String& suffix)
+    {
+        juce::PopupMenu menu;
+        for (size_t i = 0; i < N; ++i)
+            menu.addItem(firstId + (int)i, juce::String(values[i], values[i] < 2.0f ? 1 : 0) + suffix, true, values[i] == current);
+        return menu;
+    }
+}
 
 void FrequencyGraph::resized()
 {
-    // Recreate static graph image when the component is resized
+    // Recreate the cached layers when the component is resized
     createStaticGraph();
+    rebuildDotIndex();
+    renderCurveLayer();
+    updateResponseColumns();
 }
 
 void FrequencyGraph::paint(juce::Graphics& g)
 {
+    // Back to front: the grid, the spectra, the designed response, the cached curve layer
+    // (bands included), and last whatever is being dragged. Everything but the last is cached, so a drag
+    // only costs compositing the dirty rectangle.
+    drawLayer(g, _staticGraph);
+
+    g.setColour(juce::Colours::grey.withAlpha(0.35f));
+    g.fillPath(_pre_path);
+    g.setColour(juce::Colours::limegreen.withAlpha(0.3f));
+    g.fillPath(_peak_stroke);
+    g.setColour(juce::Colours::limegreen.withAlpha(0.7f));
+    g.fillPath(_post_stroke);
+
+    {
+        juce::Graphics::ScopedSaveState clip(g);
+        g.reduceClipRegion(getGraphBounds());
+        g.setColour(juce::Colours::orange.withAlpha(0.8f));
+        g.fillPath(_response_stroke);
+    }
+
+    drawLayer(g, _curveLayer);
+
+    if (_dragged_dot_idx >= 0)
+        drawDot(g, _dragged_dot_idx, true);
+    if (_dragged_band_idx >= 0)
+        drawBand(g, _dragged_band_idx);
+}
+
+void FrequencyGraph::drawLayer(juce::Graphics& g, const juce::Image& layer) const
+{
+    if (! layer.isValid())
+        return;
 
-    // Draw the cached static graph
+    // Only the part under the clip, so a spectrum update composites a strip rather than
+    // the whole image. The clipped image shares the layer's pixels.
+    const auto source = (g.getClipBounds().toFloat() * _layer_scale).getSmallestIntegerContainer().getIntersection(layer.getBounds());
+    if (source.isEmpty())
+        return;
 
-    g.drawImageAt(_staticGraph, 0, 0);
+    g.drawImageTransformed(layer.getClippedImage(source),
+                           juce::AffineTransform::translation((float)source.getX(), (float)source.getY()).scaled(1.0f / _layer_scale));
+}
 
-    // Draw dynamic elements (_dots and lines)
+void FrequencyGraph::drawDot(juce::Graphics& g, int index, bool withSegments) const
+{
+    const auto p = dotToPoint(index);
 
     g.setColour(juce::Colours::cyan);
-    auto graphBounds = getGraphBounds();
 
-    for (size_t i = 0; i < _dots.size(); i++)
+    if (withSegments)
     {
-        float x = frequencyToX(_dots[i].first, graphBounds);
-        float y = amplitudeToY(_dots[i].second, graphBounds);
-        std::cout << x << "Hz for left of line\n";
+        if (index > 0)
+            g.drawLine({ dotToPoint(index - 1), p }, 2.0f);
+        if (index < (int)_dots.size() - 1)
+            g.drawLine({ p, dotToPoint(index + 1) }, 2.0f);
+    }
 
-        if (i > 0) {
-            float prevX = frequencyToX(_dots[i - 1].first, graphBounds);
-            float prevY = amplitudeToY(_dots[i - 1].second, graphBounds);
-            g.drawLine(prevX, prevY, x, y, 2.0f);
-        }
+    drawDotMarker(g, index);
+}
+
+void FrequencyGraph::drawDotMarker(juce::Graphics& g, int index) const
+{
+    const auto p = dotToPoint(index);
+    g.fillEllipse(p.x - 5, p.y - 5, 10, 10);
+
+    if (_dynamics[(size_t)index].enabled)
+    {
+        g.setColour(juce::Colours::orange);
+        g.drawEllipse(p.x - 8, p.y - 8, 16, 16, 1.5f);
+        g.setColour(juce::Colours::cyan);
+    }
+}
+
+void FrequencyGraph::drawBand(juce::Graphics& g, int band) const
+{
+    const auto p = bandToPoint(band);
+    const auto square = juce::Rectangle<float>(10.0f, 10.0f).withCentre(p);
+    const auto colour = juce::Colours::yellow.withAlpha(_bands[(size_t)band].enabled ? 1.0f : 0.4f);
+
+    g.setColour(colour);
+    if (_bands[(size_t)band].enabled)
+        g.fillRect(square);
+    else
+        g.drawRect(square, 1.5f);
+
+    g.setFont(10.0f);
+    g.drawText(juce::String(band + 1), juce::Rectangle<float>(20.0f, 12.0f).withCentre(p.translated(0.0f, -13.0f)),
+               juce::Justification::centred, false);
+}
+
+juce::Rectangle<int> FrequencyGraph::getBandArea(int band) const
+{
+    const auto p = bandToPoint(band);
+    return juce::Rectangle<float>(p.x - 12.0f, p.y - 21.0f, 24.0f, 29.0f).getSmallestIntegerContainer();
+}
+
+int FrequencyGraph::getClickedBandIndex(float mouseX, float mouseY) const
+{
+    // Few enough to check them all; the last drawn is on top
+    for (int band = BreakpointBands::NUM_BANDS - 1; band >= 0; --band)
+    {
+        const auto p = bandToPoint(band);
+        if (std::abs(p.x - mouseX) <= 6.0f && std::abs(p.y - mouseY) <= 6.0f)
+            return band;
+    }
+    return -1;
+}
+
+juce::Rectangle<int> FrequencyGraph::getDotArea(int index) const
+{
+    // The dot and both segments touching it, plus the dot radius and stroke
+    auto area = juce::Rectangle<float>(dotToPoint(index), dotToPoint(index));
+
+    if (index > 0)
+        area = area.getUnion(juce::Rectangle<float>(dotToPoint(index - 1), dotToPoint(index)));
+    if (index < (int)_dots.size() - 1)
+        area = area.getUnion(juce::Rectangle<float>(dotToPoint(index), dotToPoint(index + 1)));
+
+    return area.expanded(10.0f).getSmallestIntegerContainer(); // Room for a dynamic dot's ring
+}
+
+void FrequencyGraph::renderCurveLayer()
+{
+    // Every segment and dot except the one being dragged, which paint() draws live
+    auto bounds = getLocalBounds();
+    if (bounds.isEmpty())
+        return;
 
-        g.fillEllipse(x - 5, y - 5, 10, 10); // Draw dot
+    _layer_scale = juce::Component::getApproximateScaleFactorForComponent(this);
+    _curveLayer = juce::Image(juce::Image::ARGB, juce::roundToInt(bounds.getWidth() * _layer_scale),
+                              juce::roundToInt(bounds.getHeight() * _layer_scale), true);
+
+    juce::Graphics g(_curveLayer);
+    g.addTransform(juce::AffineTransform::scale(_layer_scale));
+    g.setColour(juce::Colours::cyan);
+
+    for (int i = 0; i < (int)_dots.size(); ++i)
+    {
+        if (i == _dragged_dot_idx)
+            continue;
+
+        const auto p = dotToPoint(i);
+        if (i > 0 && i - 1 != _dragged_dot_idx)
+            g.drawLine({ dotToPoint(i - 1), p }, 2.0f);
+
+        drawDotMarker(g, i);
     }
+
+    for (int band = 0; band < BreakpointBands::NUM_BANDS; ++band)
+        if (band != _dragged_band_idx)
+            drawBand(g, band);
 }
+
 //==========================
 
 void FrequencyGraph::createStaticGraph()
@@ -41,8 +192,12 @@ void FrequencyGraph::createStaticGraph()
     auto bounds = getLocalBounds();
     auto graphBounds = getGraphBounds();
 
-    _staticGraph = juce::Image(juce::Image::RGB, bounds.getWidth(), bounds.getHeight(), true);
+    // Rendered at the display's pixel density, so it stays sharp on HiDPI screens
+    _layer_scale = juce::Component::getApproximateScaleFactorForComponent(this);
+    _staticGraph = juce::Image(juce::Image::RGB, juce::roundToInt(bounds.getWidth() * _layer_scale),
+                               juce::roundToInt(bounds.getHeight() * _layer_scale), true);
     juce::Graphics g(_staticGraph);
+    g.addTransform(juce::AffineTransform::scale(_layer_scale));
 
     // Draw background
     g.fillAll(juce::Colours::black);
@@ -86,6 +241,230 @@ void FrequencyGraph::createStaticGraph()
     }
 }
 
+void FrequencyGraph::setDots(std::vector<std::pair<float, float>> dots, std::vector<DotDynamics> dynamics)
+{
+    // Keep the default flat line if we're handed an empty curve
+    if (dots.empty())
+        return;
+
+    if (dynamics.size() != dots.size())
+        dynamics.assign(dots.size(), DotDynamics{});
+
+    _dots = std::move(dots);
+    _dynamics = std::move(dynamics);
+    _dragged_dot_idx = -1;
+    rebuildDotIndex();
+    renderCurveLayer();
+    repaint();
+}
+
+void FrequencyGraph::setBands(const Bands& bands)
+{
+    juce::Rectangle<int> dirty;
+    for (int band = 0; band < BreakpointBands::NUM_BANDS; ++band)
+    {
+        if (band == _dragged_band_idx || bands[(size_t)band] == _bands[(size_t)band])
+            continue;
+
+        dirty = dirty.getUnion(getBandArea(band));
+        _bands[(size_t)band] = bands[(size_t)band];
+        dirty = dirty.getUnion(getBandArea(band));
+    }
+
+    if (dirty.isEmpty())
+        return;
+
+    renderCurveLayer();
+    repaint(dirty);
+}
+
+void FrequencyGraph::changeBand(int band, const BreakpointSettings& settings)
+{
+    auto dirty = getBandArea(band);
+    _bands[(size_t)band] = settings;
+    repaint(dirty.getUnion(getBandArea(band)));
+
+    if (onBandChanged)
+        onBandChanged(band, settings);
+}
+
+void FrequencyGraph::setResponse(const CoefficientBank& bank, double sampleRate)
+{
+    _response_bank = bank;
+    _has_response = true;
+
+    if (sampleRate != _response_sample_rate)
+    {
+        _response_sample_rate = sampleRate;
+        updateResponseColumns();
+        repaint(getGraphBounds());
+        return;
+    }
+
+    // Only the sections that changed get re-evaluated, and only the columns that moved repainted
+    const auto previous = _response.getMagnitudeDb();
+    _response.update(_response_bank);
+    const auto& current = _response.getMagnitudeDb();
+    auto before = _response_stroke.getBounds();
+    updateResponsePath();
+
+    int first = (int)current.size(), last = -1;
+    for (int i = 0; i < (int)current.size(); ++i)
+    {
+        if (current[(size_t)i] != previous[(size_t)i])
+        {
+            first = juce::jmin(first, i);
+            last = i;
+        }
+    }
+
+    if (last < 0)
+        return;
+
+    auto graphBounds = getGraphBounds();
+    auto dirty = before.getUnion(_response_stroke.getBounds()).getSmallestIntegerContainer()
+                     .withLeft(graphBounds.getX() + first - 2)
+                     .withRight(graphBounds.getX() + last + 3);
+    repaint(dirty.getIntersection(graphBounds));
+}
+
+void FrequencyGraph::updateResponsePath()
+{
+    auto graphBounds = getGraphBounds();
+    const auto& response = _response.getMagnitudeDb();
+
+    juce::Path path;
+    if (_has_response && (int)response.size() == graphBounds.getWidth())
+    {
+        for (size_t i = 0; i < response.size(); ++i)
+        {
+            const float x = (float)(graphBounds.getX() + (int)i);
+            const float y = amplitudeToY(juce::jlimit(-30.0f, 30.0f, response[i]), graphBounds);
+
+            if (i == 0)
+                path.startNewSubPath(x, y);
+            else
+                path.lineTo(x, y);
+        }
+    }
+
+    _response_stroke.clear();
+    juce::PathStrokeType(1.5f).createStrokedPath(_response_stroke, path);
+}
+
+void FrequencyGraph::updateResponseColumns()
+{
+    if (_response_sample_rate <= 0.0)
+        return;
+
+    auto graphBounds = getGraphBounds();
+    std::vector<float> frequencies((size_t)juce::jmax(0, graphBounds.getWidth()));
+
+    // The frequency under the middle of each pixel column
+    for (size_t i = 0; i < frequencies.size(); ++i)
+        frequencies[i] = _freq_bounds.first * std::pow(10.0f, ((float)i + 0.5f) / graphBounds.getWidth() * _log_ratio);
+
+    _response.setFrequencies(frequencies, _response_sample_rate);
+    _response.update(_response_bank);
+    updateResponsePath();
+}
+
+void FrequencyGraph::setSpectra(const SpectrumAnalyzer& pre, const SpectrumAnalyzer& post, double sampleRate)
+{
+    // Hidden, the next update after it's shown catches up
+    if (! isShowing())
+        return;
+
+    const auto before = _pre_path.getBounds().getUnion(_post_stroke.getBounds()).getUnion(_peak_stroke.getBounds());
+
+    spectrumToColumns(pre.getSpectrumDb(), sampleRate / pre.getFftSize(), _pre_columns);
+    spectrumToColumns(post.getSpectrumDb(), sampleRate / post.getFftSize(), _post_columns);
+    spectrumToColumns(post.getPeakDb(), sampleRate / post.getFftSize(), _peak_columns);
+
+    // Build the paths once here rather than on every paint
+    auto graphBounds = getGraphBounds();
+    auto columnsToPath = [&](const std::vector<float>& columns)
+    {
+        juce::Path path;
+        for (size_t i = 0; i < columns.size(); ++i)
+        {
+            const float x = (float)(graphBounds.getX() + (int)i);
+            const float y = spectrumToY(columns[i], graphBounds);
+            if (i == 0)
+                path.startNewSubPath(x, y);
+            else
+                path.lineTo(x, y);
+        }
+        return path;
+    };
+
+    _pre_path = columnsToPath(_pre_columns);
+    if (! _pre_path.isEmpty())
+    {
+        _pre_path.lineTo((float)graphBounds.getRight(), (float)graphBounds.getBottom());
+        _pre_path.lineTo((float)graphBounds.getX(), (float)graphBounds.getBottom());
+        _pre_path.closeSubPath();
+    }
+
+    _post_stroke.clear();
+    _peak_stroke.clear();
+    juce::PathStrokeType(1.0f).createStrokedPath(_post_stroke, columnsToPath(_post_columns));
+    juce::PathStrokeType(1.0f).createStrokedPath(_peak_stroke, columnsToPath(_peak_columns));
+
+    // Only where the spectra were and are now; everything over and under them is cached
+    const auto after = _pre_path.getBounds().getUnion(_post_stroke.getBounds()).getUnion(_peak_stroke.getBounds());
+    repaint(before.getUnion(after).getSmallestIntegerContainer().expanded(1).getIntersection(graphBounds));
+}
+
+void FrequencyGraph::spectrumToColumns(const std::vector<float>& binsDb, double binWidth, std::vector<float>& columns) const
+{
+    auto graphBounds = getGraphBounds();
+    const int width = juce::jmax(0, graphBounds.getWidth());
+    const int numBins = (int)binsDb.size();
+    columns.assign((size_t)width, SPECTRUM_FLOOR_DB);
+
+    if (numBins < 2 || binWidth <= 0.0)
+        return;
+
+    // Low columns are narrower than a bin, so interpolate; high ones span many bins, so take the loudest
+    auto binAt = [&](int column) { return _freq_bounds.first * std::pow(10.0f, (float)column / width * _log_ratio) / (float)binWidth; };
+
+    for (int i = 0; i < width; ++i)
+    {
+        const float lo = binAt(i);
+        const float hi = binAt(i + 1);
+        const int first = (int)std::ceil(lo);
+        const int last = juce::jmin(numBins - 1, (int)std::floor(hi));
+
+        if (first <= last)
+        {
+            float loudest = binsDb[(size_t)first];
+            for (int k = first + 1; k <= last; ++k)
+                loudest = juce::jmax(loudest, binsDb[(size_t)k]);
+            columns[(size_t)i] = loudest;
+        }
+        else
+        {
+            const float centre = juce::jlimit(0.0f, (float)(numBins - 1), 0.5f * (lo + hi));
+            const int k = juce::jmin(numBins - 2, (int)centre);
+            const float frac = centre - (float)k;
+            columns[(size_t)i] = binsDb[(size_t)k] + frac * (binsDb[(size_t)k + 1] - binsDb[(size_t)k]);
+        }
+    }
+}
+
+void FrequencyGraph::rebuildDotIndex()
+{
+    auto graphBounds = getGraphBounds();
+    std::vector<juce::Point<float>> points;
+    points.reserve(_dots.size());
+
+    for (const auto& dot : _dots)
+        points.push_back(dotToScreen(dot, graphBounds));
+
+    _dot_index.rebuild(std::move(points));
+}
+
 juce::Rectangle<int> FrequencyGraph::getGraphBounds() const
 {
 
@@ -107,14 +486,36 @@ void FrequencyGraph::mouseDown(const juce::MouseEvent& event)
     float mouseX = event.position.x;
     float mouseY = event.position.y;
 
-    std::cout << "Click: " << mouseX << ", " << mouseY << "\n";
+    DRAW_TRACE("Click: %.1f, %.1f", mouseX, mouseY);
 
     // Check if we clicked on an existing dot
-    int clickedDotIndex = getClickedDotIndex(mouseX, mouseY, graphBounds);
+    int clickedDotIndex = getClickedDotIndex(mouseX, mouseY);
+    if (clickedDotIndex != -1 && event.mods.isPopupMenu())
+    {
+        showDynamicsMenu(clickedDotIndex);
+        return;
+    }
     if (clickedDotIndex != -1)
     {
-        // Start dragging this dot
+        // Start dragging this dot: it comes out of the cached layer and is drawn live
         _dragged_dot_idx = clickedDotIndex;
+        renderCurveLayer();
+        return;
+    }
+
+    // Then the bands, which the dots sit on top of
+    const int clickedBandIndex = getClickedBandIndex(mouseX, mouseY);
+    if (clickedBandIndex != -1 && event.mods.isPopupMenu())
+    {
+        showBandMenu(clickedBandIndex);
+        return;
+    }
+    if (clickedBandIndex != -1)
+    {
+        _dragged_band_idx = clickedBandIndex;
+        if (onBandGesture)
+            onBandGesture(clickedBandIndex, true);
+        renderCurveLayer();
         return;
     }
     // Otherwise, split the closest line
@@ -145,25 +546,116 @@ void FrequencyGraph::mouseDown(const juce::MouseEvent& event)
         index = std::distance(_dots.begin(), it);
     }
 
-    // Calculate index
+    // The segment being split, before it's split
+    auto dirty = (index > 0) ? getDotArea((int)index - 1) : getDotArea((int)index);
 
     _dots.insert(_dots.begin() + index, { freq, amp });
+    _dynamics.insert(_dynamics.begin() + index, DotDynamics{});
+    _dot_index.insert((int)index, dotToScreen(_dots[index], graphBounds));
 
-    for (size_t i = 0; i < _dots.size(); i++) {
-        std::cout << _dots[i].first << "Hz, ";
-    }
-
-    std::cout << (index + 1) << "th dot added\n";
+    DRAW_TRACE("%dth dot added at %.1f Hz, %d dots", (int)index + 1, freq, (int)_dots.size());
 
     _dragged_dot_idx = index;
+    renderCurveLayer();
 
-    repaint();
+    repaint(dirty.getUnion(getDotArea(_dragged_dot_idx)));
+
+    if (onCurveChanged)
+        onCurveChanged();
 }
 
 
 
+void FrequencyGraph::showDynamicsMenu(int index)
+{
+    const auto dynamics = _dynamics[(size_t)index];
+
+    juce::PopupMenu menu;
+    menu.addSectionHeader(juce::String(_dots[(size_t)index].first, 0) + " Hz");
+    menu.addItem(TOGGLE_ID, "Dynamic", true, dynamics.enabled);
+    menu.addSeparator();
+
+    // Picking a setting makes the dot dynamic too
+    menu.addSubMenu("Threshold", makeChoices(THRESHOLD_ID, THRESHOLDS_DB, dynamics.threshold_db, " dB"));
+    menu.addSubMenu("Ratio", makeChoices(RATIO_ID, RATIOS, dynamics.ratio, ":1"));
+    menu.addSubMenu("Attack", makeChoices(ATTACK_ID, ATTACKS_MS, dynamics.attack_ms, " ms"));
+    menu.addSubMenu("Release", makeChoices(RELEASE_ID, RELEASES_MS, dynamics.release_ms, " ms"));
+
+    // The menu is asynchronous, so check the dot is still the one it was opened for
+    const auto dot = _dots[(size_t)index];
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(this).withMousePosition(),
+                       [graph = juce::Component::SafePointer<FrequencyGraph>(this), index, dot](int result)
+    {
+        if (result == 0 || graph == nullptr || index >= (int)graph->_dots.size() || graph->_dots[(size_t)index] != dot)
+            return;
+
+        auto& d = graph->_dynamics[(size_t)index];
+        const bool wasEnabled = d.enabled;
+        d.enabled = true;
+
+        if (result == TOGGLE_ID)
+            d.enabled = ! wasEnabled;
+        else if (result >= RELEASE_ID)
+            d.release_ms = RELEASES_MS[result - RELEASE_ID];
+        else if (result >= ATTACK_ID)
+            d.attack_ms = ATTACKS_MS[result - ATTACK_ID];
+        else if (result >= RATIO_ID)
+            d.ratio = RATIOS[result - RATIO_ID];
+        else if (result >= THRESHOLD_ID)
+            d.threshold_db = THRESHOLDS_DB[result - THRESHOLD_ID];
+
+        graph->renderCurveLayer();
+        graph->repaint(graph->getDotArea(index));
+
+        if (graph->onCurveChanged)
+            graph->onCurveChanged();
+    });
+}
+
+void FrequencyGraph::showBandMenu(int band)
+{
+    const auto settings = _bands[(size_t)band];
+
+    juce::PopupMenu menu;
+    menu.addSectionHeader("Band " + juce::String(band + 1) + ", " + juce::String(settings.freq, 0) + " Hz");
+    menu.addItem(TOGGLE_ID, "On", true, settings.enabled);
+    menu.addSubMenu("Q", makeChoices(Q_ID, BAND_QS, settings.q, ""));
+
+    // Bands don't come and go like dots, so the index is still good when the menu returns
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(this).withMousePosition(),
+                       [graph = juce::Component::SafePointer<FrequencyGraph>(this), band](int result)
+    {
+        if (result == 0 || graph == nullptr)
+            return;
+
+        auto settings = graph->_bands[(size_t)band];
+        if (result == TOGGLE_ID)
+            settings.enabled = ! settings.enabled;
+        else if (result >= Q_ID)
+            settings.q = BAND_QS[result - Q_ID];
+
+        if (graph->onBandGesture)
+            graph->onBandGesture(band, true);
+        graph->changeBand(band, settings);
+        graph->renderCurveLayer();
+        if (graph->onBandGesture)
+            graph->onBandGesture(band, false);
+    });
+}
+
 void FrequencyGraph::mouseDrag(const juce::MouseEvent& event)
 {
+    if (_dragged_band_idx >= 0)
+    {
+        auto graphBounds = getGraphBounds();
+        auto settings = _bands[(size_t)_dragged_band_idx];
+        settings.freq = juce::jlimit(BreakpointBands::MIN_FREQ, BreakpointBands::MAX_FREQ, xToFrequency(event.position.x, graphBounds));
+        settings.gain_db = juce::jlimit(-24.0f, 24.0f, yToAmplitude(event.position.y, graphBounds));
+        settings.enabled = true;
+        changeBand(_dragged_band_idx, settings);
+        return;
+    }
+
     if (_dragged_dot_idx >= 0)
     {
         auto graphBounds = getGraphBounds();
@@ -178,12 +670,32 @@ void FrequencyGraph::mouseDrag(const juce::MouseEvent& event)
         freq = juce::jlimit(leftBound, rightBound, freq);
         amp = juce::jlimit(-24.0f, 24.0f, amp);
 
+        // Only where the dot and its two segments were, and where they are now
+        auto dirty = getDotArea(_dragged_dot_idx);
         _dots[_dragged_dot_idx] = { freq, amp };
-        repaint();
+        _dot_index.move(_dragged_dot_idx, dotToScreen(_dots[_dragged_dot_idx], graphBounds));
+        repaint(dirty.getUnion(getDotArea(_dragged_dot_idx)));
+
+        if (onCurveChanged)
+            onCurveChanged();
     }
 }
 
 void FrequencyGraph::mouseUp(const juce::MouseEvent&)
 {
+    if (_dragged_band_idx >= 0)
+    {
+        if (onBandGesture)
+            onBandGesture(_dragged_band_idx, false);
+        _dragged_band_idx = -1;
+        renderCurveLayer();
+        return;
+    }
+
+    if (_dragged_dot_idx < 0)
+        return;
+
+    // Bake the dot back into the cached layer; nothing on screen changes
     _dragged_dot_idx = -1; // Reset dragged dot
+    renderCurveLayer();
 }
@@ -1,7 +1,16 @@
 /* Component that manages a graph with an interactive line */
 
+#pragma once
+
 #include <JuceHeader.h>
 #include <algorithm>
+#include <functional>
+#include "../dsp/BreakpointBands.h"
+#include "../dsp/Curve.h"
+#include "../dsp/ResponseCache.h"
+#include "../dsp/SpectrumAnalyzer.h"
+#include "DotIndex.h"
+#include "../debug/Trace.h"
 
 class FrequencyGraph : public juce::Component
 {
@@ -14,6 +23,7 @@ public:
             {_freq_bounds.first, 0.0f},
             {_freq_bounds.second, 0.0f}
         };
+        _dynamics.resize(_dots.size());
     }
 
     void resized() override;
@@ -29,6 +39,31 @@ public:
 
     void mouseUp(const juce::MouseEvent&) override;
 
+    // Dots: frequency (Hz), amplitude (dB), sorted by frequency
+    const std::vector<std::pair<float, float>>& getDots() const { return _dots; }
+    // Without one dynamics per dot, every dot is static
+    void setDots(std::vector<std::pair<float, float>> dots, std::vector<DotDynamics> dynamics = {});
+
+    // Each dot's dynamics, set from the menu a right-click on the dot brings up
+    const std::vector<DotDynamics>& getDynamics() const { return _dynamics; }
+
+    // Called on the message thread whenever the user adds or moves a dot, or changes its dynamics
+    std::function<void()> onCurveChanged;
+
+    // The breakpoint bands (see BreakpointBands), drawn as squares apart from the dots: on
+    // at full colour, off dimmed. Dragging one switches it on; a right-click brings up its
+    // menu. The one being dragged ignores setBands() until it's let go.
+    using Bands = std::array<BreakpointSettings, BreakpointBands::NUM_BANDS>;
+    void setBands(const Bands& bands);
+    std::function<void(int band, const BreakpointSettings& settings)> onBandChanged;
+    std::function<void(int band, bool starting)> onBandGesture; // Around each drag or menu edit
+
+    // Overlay the magnitude response of the cascade the engine is actually running
+    void setResponse(const CoefficientBank& bank, double sampleRate);
+
+    // Draw the input and output spectra behind the curve
+    void setSpectra(const SpectrumAnalyzer& pre, const SpectrumAnalyzer& post, double sampleRate);
+
 private:
 
     // Drawing
@@ -37,9 +72,54 @@ private:
     const float _log_ratio = std::log10(_freq_bounds.second / _freq_bounds.first); // ~2.3
     juce::Image _staticGraph;
 
+    // Cached curve layer: every dot and segment except the dragged dot's, which are drawn live
+    void renderCurveLayer();
+    void drawLayer(juce::Graphics& g, const juce::Image& layer) const;
+    void drawDot(juce::Graphics& g, int index, bool withSegments) const;
+    void drawDotMarker(juce::Graphics& g, int index) const; // Dynamic dots get a ring
+    juce::Rectangle<int> getDotArea(int index) const;
+    juce::Image _curveLayer;
+    float _layer_scale = 1.0f; // Physical pixels per logical pixel of both cached layers
+
     std::vector<std::pair<float, float>> _dots; // Dots: frequency (Hz), amplitude (dB)
+    std::vector<DotDynamics> _dynamics;         // One per dot
     int _dragged_dot_idx = -1;
 
+    void showDynamicsMenu(int index);
+
+    Bands _bands = BreakpointBands::getDefaults();
+    int _dragged_band_idx = -1;
+
+    void drawBand(juce::Graphics& g, int band) const;
+    juce::Rectangle<int> getBandArea(int band) const; // The square and its number
+    int getClickedBandIndex(float mouseX, float mouseY) const;
+    void showBandMenu(int band);
+    void changeBand(int band, const BreakpointSettings& settings);
+
+    // Screen positions of _dots, kept in step with every edit
+    void rebuildDotIndex();
+    DotIndex _dot_index;
+
+    // Designed response, evaluated at every pixel column of the graph
+    void updateResponseColumns();
+    void updateResponsePath();
+    ResponseCache _response;
+    CoefficientBank _response_bank;
+    double _response_sample_rate = 0.0;
+    bool _has_response = false;
+
+    // Spectra resampled to one value per pixel column: pre, post, post peak hold (dBFS)
+    static constexpr float SPECTRUM_FLOOR_DB = -90.0f;
+    void spectrumToColumns(const std::vector<float>& binsDb, double binWidth, std::vector<float>& columns) const;
+    float spectrumToY(float db, juce::Rectangle<int> bounds) const
+    {
+        return bounds.getBottom() - juce::jlimit(0.0f, 1.0f, 1.0f - db / SPECTRUM_FLOOR_DB) * bounds.getHeight();
+    }
+    std::vector<float> _pre_columns, _post_columns, _peak_columns;
+
+    // Ready-to-fill outlines, rebuilt only when their data changes
+    juce::Path _pre_path, _post_stroke, _peak_stroke, _response_stroke;
+
 
     // Map frequency (log scale) to X position
     float frequencyToX(float freq, juce::Rectangle<int> bounds) const
@@ -50,6 +130,20 @@ private:
         return bounds.getX() + bounds.getWidth() * std::log10(freq / _freq_bounds.first) / _log_ratio;
     }
 
+    // Screen position of a dot, from the index (no log10)
+    juce::Point<float> dotToPoint(int index) const { return _dot_index.getPoint(index); }
+
+    juce::Point<float> bandToPoint(int band) const
+    {
+        const auto& settings = _bands[(size_t)band];
+        return dotToScreen({ settings.freq, settings.gain_db }, getGraphBounds());
+    }
+
+    juce::Point<float> dotToScreen(const std::pair<float, float>& dot, juce::Rectangle<int> bounds) const
+    {
+        return { frequencyToX(dot.first, bounds), amplitudeToY(dot.second, bounds) };
+    }
+
     // Map amplitude to Y position
     float amplitudeToY(float amp, juce::Rectangle<int> bounds) const
     {
@@ -61,7 +155,7 @@ private:
     {
         float x_offset = x - bounds.getX();
         float result =  _freq_bounds.first * std::pow(10.0f, x_offset / bounds.getWidth() * _log_ratio);
-        std::cout << "X @ offset " << x_offset << " to frquency:\n\tLog10(20k/100)=" << _log_ratio << "\n\tFinal freq=" << result << "\n";
+        DRAW_TRACE("X @ offset %.1f to frequency: log10(20k/10)=%.3f, freq=%.1f Hz", x_offset, _log_ratio, result);
         return result;
     }
 
@@ -71,65 +165,24 @@ private:
         return 24.0f - (y - bounds.getY()) * 48.0f / bounds.getHeight();
     }
 
-    void debug_dot(uint8_t index, float x, float y, float freq) const
-    {
-        std::cout << "dot " << index << ": " <<  "(" << x << ", " << y << ")" << " " << freq << "Hz\n";
-    }
-
-    int getClickedDotIndex(float mouseX, float mouseY, const juce::Rectangle<int>& bounds) const
+    void debug_dot(int index, float x, float y, float freq) const
     {
-        for (size_t i = 0; i < _dots.size(); ++i)
-        {
-            float x = frequencyToX(_dots[i].first, bounds);
-            float y = amplitudeToY(_dots[i].second, bounds);
-            debug_dot(i, x, y, _dots[i].first);
-            // Check if the mouse click is within the dot's radius
-            if (std::hypot(mouseX - x, mouseY - y) <= 5.0f)
-                return static_cast<int>(i);
-        }
-        return -1; // No dot clicked
+        DRAW_TRACE("dot %d: (%.1f, %.1f) %.1f Hz", index, x, y, freq);
     }
 
-    size_t findClosestLineSegment(float freq, float amp, const juce::Rectangle<int>& bounds) const
+    int getClickedDotIndex(float mouseX, float mouseY) const
     {
-        size_t closestIndex = 0;
-        float closestDistance = std::numeric_limits<float>::max();
-
-        for (size_t i = 0; i < _dots.size() - 1; ++i)
-        {
-            auto x1 = frequencyToX(_dots[i].first, bounds);
-            auto y1 = amplitudeToY(_dots[i].second, bounds);
-            auto x2 = frequencyToX(_dots[i + 1].first, bounds);
-            auto y2 = amplitudeToY(_dots[i + 1].second, bounds);
-
-            float distance = pointToLineSegmentDistance({ x1, y1 }, { x2, y2 }, { freq, amp });
-            if (distance < closestDistance)
-            {
-                closestDistance = distance;
-                closestIndex = i;
-            }
-        }
-
-        return closestIndex;
+        // Check if the mouse click is within a dot's radius
+        const int index = _dot_index.findDot({ mouseX, mouseY }, 5.0f);
+        if (index >= 0)
+            debug_dot(index, dotToPoint(index).x, dotToPoint(index).y, _dots[(size_t)index].first);
+        return index; // -1 if no dot clicked
     }
 
-    float pointToLineSegmentDistance(juce::Point<float> p1, juce::Point<float> p2, juce::Point<float> p) const
+    // Segment from dot i to dot i + 1 nearest to a screen position, or -1
+    int findClosestLineSegment(float mouseX, float mouseY) const
     {
-        auto d = p2 - p1;
-        float lenSquared = d.x * d.x + d.y * d.y; // Squared length of the line segment
-
-        if (lenSquared == 0.0f)
-            return p.getDistanceFrom(p1); // If the line segment is a point, return distance to p1
-
-        // Project the point onto the line segment and clamp to the segment
-        auto t = ((p.x - p1.x) * d.x + (p.y - p1.y) * d.y) / lenSquared;
-        t = juce::jlimit(0.0f, 1.0f, t);
-
-        // Compute the projection point
-        auto projection = p1 + d * t;
-
-        // Return the distance from the point to the projection
-        return p.getDistanceFrom(projection);
+        return _dot_index.findSegment({ mouseX, mouseY });
     }
 
 };
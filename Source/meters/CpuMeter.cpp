@@ -0,0 +1,61 @@
+#include <JuceHeader.h>
+#include "CpuMeter.h"
+
+CpuMeter::CpuMeter(PerformanceCounters& counters)
+    : _counters(counters)
+{
+    _last = _counters.getSnapshot();
+    startTimerHz(REFRESH_HZ);
+}
+
+void CpuMeter::timerCallback()
+{
+    const auto snapshot = _counters.getSnapshot();
+
+    // prepareToPlay clears the counters, so start over if they went backwards
+    if (snapshot.num_blocks < _last.num_blocks)
+        _last = {};
+
+    const auto budgetNs = snapshot.budget_ns - _last.budget_ns;
+    _utilisation = budgetNs > 0 ? (float)(snapshot.busy_ns - _last.busy_ns) / (float)budgetNs : 0.0f;
+    _peak_utilisation = _counters.takePeakUtilisation();
+    _last = snapshot;
+
+    repaint();
+}
+
+void CpuMeter::paint(juce::Graphics& g)
+{
+    auto bounds = getLocalBounds().toFloat();
+    auto bar = bounds.removeFromLeft(bounds.getWidth() * 0.35f).reduced(0.0f, 4.0f);
+
+    const bool clean = _last.getNumOverruns() == 0 && _last.non_finite_in + _last.non_finite_out == 0
+                    && _last.state_resets + _last.sections_replaced == 0;
+    const auto colour = ! clean ? juce::Colours::red : _peak_utilisation > 0.5f ? juce::Colours::orange : juce::Colours::limegreen;
+
+    g.setColour(juce::Colours::black.withAlpha(0.4f));
+    g.fillRect(bar);
+    g.setColour(colour.withAlpha(0.8f));
+    g.fillRect(bar.withWidth(bar.getWidth() * juce::jlimit(0.0f, 1.0f, _utilisation)));
+
+    const auto peakX = bar.getX() + bar.getWidth() * juce::jlimit(0.0f, 1.0f, _peak_utilisation);
+    g.setColour(colour);
+    g.drawVerticalLine(juce::roundToInt(peakX), bar.getY(), bar.getBottom());
+    g.setColour(juce::Colours::grey);
+    g.drawRect(bar);
+
+    // Counts as in / out, so it's clear whether bad samples came from upstream
+    auto text = "CPU " + juce::String(100.0f * _utilisation, 1) + "%, peak " + juce::String(100.0f * _peak_utilisation, 0) + "%";
+    if (_last.getNumOverruns() > 0)
+        text << ", " << juce::String(_last.getNumOverruns()) << " overruns";
+    if (_last.non_finite_in + _last.non_finite_out > 0)
+        text << ", NaN " << juce::String(_last.non_finite_in) << "/" << juce::String(_last.non_finite_out);
+    if (_last.denormal_in + _last.denormal_out > 0)
+        text << ", denormal " << juce::String(_last.denormal_in) << "/" << juce::String(_last.denormal_out);
+    if (_last.state_resets + _last.sections_replaced > 0)
+        text << ", filter resets " << juce::String(_last.state_resets) << ", unstable " << juce::String(_last.sections_replaced);
+
+    g.setColour(clean ? juce::Colours::white : juce::Colours::red);
+    g.setFont(juce::FontOptions(12.0f));
+    g.drawFittedText(text, bounds.withTrimmedLeft(6.0f).toNearestInt(), juce::Justification::centredLeft, 1);
+}
@@ -0,0 +1,30 @@
+/* Compact CPU meter fed by a processor's performance counters */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../dsp/PerformanceCounters.h"
+
+/* A bar for the share of real time processBlock took over the last refresh, a tick for
+   the worst single block in it, and the totals since prepareToPlay as text: overruns,
+   and blocks with NaN / Inf or denormal samples, in and out. Turns red on anything
+   that would be heard. */
+class CpuMeter : public juce::Component, private juce::Timer
+{
+public:
+    explicit CpuMeter(PerformanceCounters& counters);
+
+    void paint(juce::Graphics& g) override;
+
+private:
+    static constexpr int REFRESH_HZ = 4;
+
+    void timerCallback() override;
+
+    PerformanceCounters& _counters;
+    PerformanceCounters::Snapshot _last; // At the previous refresh, to difference against
+    float _utilisation = 0.0f;
+    float _peak_utilisation = 0.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CpuMeter)
+};
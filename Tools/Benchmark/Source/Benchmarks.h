@@ -0,0 +1,102 @@
+/* Timing helpers and the list of benchmarks the runner knows about */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+/* Wall-clock statistics of repeated runs of one operation */
+struct Timing
+{
+    double min_ms = 0.0;
+    double median_ms = 0.0;
+    double mean_ms = 0.0;
+    int runs = 0;
+};
+
+// One untimed warm-up run (page faults, caches), then runs timed ones
+inline Timing timeRuns(int runs, const std::function<void()>& operation)
+{
+    operation();
+
+    std::vector<double> ms((size_t)runs);
+    for (auto& m : ms)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+        operation();
+        m = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1000.0;
+    }
+
+    Timing timing;
+    timing.runs = runs;
+    if (runs == 0)
+        return timing;
+
+    std::sort(ms.begin(), ms.end());
+    timing.min_ms = ms.front();
+    timing.median_ms = ms[ms.size() / 2];
+    for (const auto m : ms)
+        timing.mean_ms += m / runs;
+    return timing;
+}
+
+/* Everything the benchmarks report, for --json: one object per case, tagged with the
+   benchmark that was running (set by main) */
+struct Results
+{
+    static juce::String& currentBenchmark()
+    {
+        static juce::String name;
+        return name;
+    }
+
+    static juce::Array<juce::var>& get()
+    {
+        static juce::Array<juce::var> results;
+        return results;
+    }
+
+    static void add(const juce::String& name, const juce::NamedValueSet& values)
+    {
+        auto* result = new juce::DynamicObject();
+        result->setProperty("benchmark", currentBenchmark());
+        result->setProperty("name", name);
+        for (const auto& value : values)
+            result->setProperty(value.name, value.value);
+        get().add(juce::var(result));
+    }
+
+    // Set by the benchmarks that also check correctness; main returns non-zero if so
+    static bool& failed()
+    {
+        static bool any = false;
+        return any;
+    }
+};
+
+inline void printTiming(const juce::String& name, const Timing& timing, const juce::String& detail = {})
+{
+    juce::NamedValueSet values;
+    values.set("min_ms", timing.min_ms);
+    values.set("median_ms", timing.median_ms);
+    values.set("mean_ms", timing.mean_ms);
+    values.set("runs", timing.runs);
+    Results::add(name, values);
+
+    std::cout << name.paddedRight(' ', 40)
+              << "  min " << juce::String(timing.min_ms, 3).paddedLeft(' ', 9) << " ms"
+              << "  median " << juce::String(timing.median_ms, 3).paddedLeft(' ', 9) << " ms"
+              << "  " << detail << std::endl;
+}
+
+// Each lives in its own file
+void runImportBenchmark();
+void runCascadeBenchmark();
+void runFitBenchmark();
+void runGlideBenchmark();
+void runHandoffBenchmark();
+void runOversamplingBenchmark();
+void runProcessBenchmark();
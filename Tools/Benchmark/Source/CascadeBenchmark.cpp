@@ -0,0 +1,117 @@
+#include <JuceHeader.h>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Benchmarks.h"
+#include "../../../Source/dsp/BiquadCascade.h"
+
+namespace
+{
+    constexpr double SAMPLE_RATE = 48000.0;
+    constexpr int BLOCK_SIZE = 512;
+    constexpr int RUNS = 2000;
+    const int SECTION_COUNTS[] = { 8, 16, 64, 256 };
+
+    // One section per dot, as CurveDesigner makes them
+    CoefficientBank makeBank(int numSections)
+    {
+        std::vector<std::pair<float, float>> dots;
+        for (int i = 0; i < numSections; ++i)
+        {
+            const float t = (float)i / (float)(numSections - 1);
+            dots.emplace_back(20.0f * std::pow(1000.0f, t), 6.0f * std::sin(t * 9.0f));
+        }
+
+        CoefficientBank bank;
+        CurveDesigner::design(CurveSnapshot::fromDots(dots), SAMPLE_RATE, bank);
+        return bank;
+    }
+
+    std::vector<float> makeNoise()
+    {
+        std::vector<float> noise((size_t)BLOCK_SIZE);
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> distribution(-0.5f, 0.5f);
+        for (auto& sample : noise)
+            sample = distribution(random);
+        return noise;
+    }
+
+    juce::String describe(const Timing& timing)
+    {
+        return juce::String(timing.median_ms * 1.0e6 / BLOCK_SIZE, 2) + " ns/sample";
+    }
+
+    // One channel, one block at a time, the same noise every block
+    void benchmarkSections(int numSections)
+    {
+        auto bank = makeBank(numSections);
+        const auto noise = makeNoise();
+        std::vector<float> data = noise;
+        const auto prefix = juce::String(numSections) + " sections, ";
+
+        // The baseline: a juce::dsp::IIR::Filter per section, each run over the block in turn
+        juce::OwnedArray<juce::dsp::IIR::Filter<float>> filters;
+        for (int s = 0; s < bank.num_sections; ++s)
+        {
+            const auto section = bank.getSection(s);
+            auto* filter = filters.add(new juce::dsp::IIR::Filter<float>(
+                new juce::dsp::IIR::Coefficients<float>(section.b0, section.b1, section.b2, 1.0f, section.a1, section.a2)));
+            filter->prepare({ SAMPLE_RATE, (juce::uint32)BLOCK_SIZE, 1 });
+        }
+
+        const auto juceTiming = timeRuns(RUNS, [&]
+        {
+            std::copy(noise.begin(), noise.end(), data.begin());
+            float* channels[] = { data.data() };
+            juce::dsp::AudioBlock<float> block(channels, 1, (size_t)BLOCK_SIZE);
+            juce::dsp::ProcessContextReplacing<float> context(block);
+            for (auto* filter : filters)
+                filter->process(context);
+        });
+        const auto juceOutput = data;
+        float peak = 0.0f;
+        for (const auto sample : juceOutput)
+            peak = juce::jmax(peak, std::abs(sample));
+        printTiming(prefix + "juce::dsp::IIR::Filter", juceTiming, describe(juceTiming));
+
+        std::vector<float> s1((size_t)CoefficientBank::MAX_SECTIONS), s2((size_t)CoefficientBank::MAX_SECTIONS);
+
+        // Ours, timed from the same state as the baseline so the outputs can be compared. They
+        // differ by rounding only, the operations being in a different order: with hundreds of
+        // sections and long low-frequency memories, each is about as far from a double-precision
+        // run as from the other.
+        const auto run = [&](const juce::String& name, auto process)
+        {
+            std::fill(s1.begin(), s1.end(), 0.0f);
+            std::fill(s2.begin(), s2.end(), 0.0f);
+
+            const auto timing = timeRuns(RUNS, [&]
+            {
+                std::copy(noise.begin(), noise.end(), data.begin());
+                process(data.data());
+            });
+
+            float error = 0.0f;
+            for (size_t i = 0; i < data.size(); ++i)
+                error = juce::jmax(error, std::abs(data[i] - juceOutput[i]));
+
+            printTiming(prefix + name, timing, describe(timing) + ", " + juce::String(juceTiming.median_ms / timing.median_ms, 1)
+                                               + "x juce::dsp::IIR::Filter, max difference "
+                                               + juce::String(juce::Decibels::gainToDecibels(error / peak, -200.0f), 1) + " dB re peak");
+        };
+
+        run("BiquadCascade::processScalar", [&](float* d) { BiquadCascade::processScalar(bank, s1.data(), s2.data(), d, BLOCK_SIZE); });
+
+        BiquadCascade::padToLanes(bank);
+        run("BiquadCascade::process", [&](float* d) { BiquadCascade::process(bank, s1.data(), s2.data(), d, BLOCK_SIZE); });
+    }
+}
+
+void runCascadeBenchmark()
+{
+    std::cout << "SIMD lanes: " << BiquadCascade::getNumLanes() << std::endl;
+
+    for (const auto numSections : SECTION_COUNTS)
+        benchmarkSections(numSections);
+}
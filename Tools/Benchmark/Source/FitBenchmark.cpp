@@ -0,0 +1,88 @@
+#include <JuceHeader.h>
+#include <cmath>
+#include <random>
+#include "Benchmarks.h"
+#include "../../../Source/dsp/CurveDesigner.h"
+#include "../../../Source/dsp/CurveFitter.h"
+#include "../../../Source/dsp/EqEngine.h"
+
+namespace
+{
+    constexpr double SAMPLE_RATE = 48000.0;
+    constexpr int BLOCK_SIZE = 512;
+
+    // Audio-thread cost of running a bank: one stereo block, steady state
+    Timing timeProcessing(const CoefficientBank& bank)
+    {
+        EqEngine eq;
+        eq.prepare(SAMPLE_RATE, BLOCK_SIZE, 2);
+        eq.setCoefficients(bank, false);
+
+        juce::AudioBuffer<float> buffer(2, BLOCK_SIZE);
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+        for (int c = 0; c < 2; ++c)
+            for (int i = 0; i < BLOCK_SIZE; ++i)
+                buffer.setSample(c, i, noise(random));
+
+        return timeRuns(2000, [&] { eq.process(buffer); });
+    }
+
+    void benchmarkCurve(const juce::String& name, const std::vector<std::pair<float, float>>& dots)
+    {
+        const auto curve = CurveSnapshot::fromDots(dots);
+
+        CoefficientBank perDot, fitted;
+        const auto designTime = timeRuns(20, [&] { CurveDesigner::design(curve, SAMPLE_RATE, perDot); });
+
+        CurveFitter fitter;
+        const auto coldTime = timeRuns(5, [&]
+        {
+            fitter.reset();
+            fitter.fit(curve, SAMPLE_RATE, 0.5f, fitted);
+        });
+
+        // Dragging the middle dot a little at a time, each fit starting from the last
+        auto dragged = dots;
+        auto& dot = dragged[dragged.size() / 2];
+        const auto warmTime = timeRuns(50, [&]
+        {
+            dot.second = juce::jlimit(-24.0f, 24.0f, dot.second + 0.1f);
+            fitter.fit(CurveSnapshot::fromDots(dragged), SAMPLE_RATE, 0.5f, fitted);
+        });
+
+        fitter.reset();
+        fitter.fit(curve, SAMPLE_RATE, 0.5f, fitted);
+
+        const auto perDotProcessing = timeProcessing(perDot);
+        const auto fittedProcessing = timeProcessing(fitted);
+
+        printTiming(name + ", per-dot design", designTime, juce::String(perDot.num_sections) + " sections");
+        printTiming(name + ", fit from scratch", coldTime, juce::String(fitted.num_sections) + " sections, max error "
+                                                           + juce::String(fitter.getMaxErrorDb(), 2) + " dB");
+        printTiming(name + ", fit while dragging", warmTime);
+        printTiming(name + ", process per-dot", perDotProcessing);
+        printTiming(name + ", process fitted", fittedProcessing, juce::String(perDotProcessing.median_ms / fittedProcessing.median_ms, 1) + "x less CPU");
+    }
+}
+
+void runFitBenchmark()
+{
+    std::vector<std::pair<float, float>> smooth, detailed;
+
+    // A broad tilt with a couple of gentle bumps, drawn with a dot every 1/12 octave
+    for (int i = 0; i < 120; ++i)
+    {
+        const float freq = 10.0f * std::pow(2000.0f, (float)i / 119.0f);
+        smooth.emplace_back(freq, 4.0f * std::sin(std::log2(freq) * 1.3f) + 2.0f * std::cos(std::log2(freq) * 0.5f));
+    }
+
+    // Forty dots with independent detail at each
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> gain(-3.0f, 3.0f);
+    for (int i = 0; i < 40; ++i)
+        detailed.emplace_back(10.0f * std::pow(2000.0f, (float)i / 39.0f), gain(random) + 3.0f * std::sin((float)i * 0.4f));
+
+    benchmarkCurve("smooth, 120 dots", smooth);
+    benchmarkCurve("detailed, 40 dots", detailed);
+}
@@ -0,0 +1,144 @@
+#include <JuceHeader.h>
+#include <cmath>
+#include <vector>
+#include "Benchmarks.h"
+#include "../../../Source/dsp/EqEngine.h"
+
+namespace
+{
+    constexpr double SAMPLE_RATE = 48000.0;
+    constexpr int BLOCK_SIZE = 256;
+    constexpr int SWITCH_INTERVAL = 997; // Samples; prime, so switches land all over the block
+    constexpr int NUM_SWITCHES = 200;
+    constexpr int SETTLE_SAMPLES = 48000;
+
+    // The largest sample-to-sample step while switching may exceed the larger of the two
+    // curves' steady-state steps by this much. A glide stays well inside it; jumping
+    // between designs doesn't.
+    constexpr double MAX_STEP_RATIO = 1.5;
+
+    // The two ends of the switch: many dots at +-18 dB, one the mirror image of the other,
+    // so every section's gain swings by 36 dB
+    CurveSnapshot makeCurve(bool inverted)
+    {
+        std::vector<std::pair<float, float>> dots;
+        for (int i = 0; i < 32; ++i)
+        {
+            const float freq = 20.0f * std::pow(1000.0f, (float)i / 31.0f);
+            const float gain = (i % 2 == 0) == inverted ? 18.0f : -18.0f;
+            dots.emplace_back(freq, gain);
+        }
+        return CurveSnapshot::fromDots(dots);
+    }
+
+    // Low, mid and high tones together, so some part of the input is under a boost whichever curve is running
+    float input(juce::int64 n)
+    {
+        const auto t = (double)n / SAMPLE_RATE;
+        return (float)(0.1 * std::sin(2.0 * juce::MathConstants<double>::pi * 110.0 * t)
+                     + 0.1 * std::sin(2.0 * juce::MathConstants<double>::pi * 1234.0 * t)
+                     + 0.1 * std::sin(2.0 * juce::MathConstants<double>::pi * 6789.0 * t));
+    }
+
+    struct Run
+    {
+        EqEngine eq;
+        juce::AudioBuffer<float> buffer{ 1, BLOCK_SIZE };
+        juce::int64 position = 0;
+        float previous = 0.0f;
+        double max_step = 0.0;
+
+        Run(const CoefficientBank& bank)
+        {
+            eq.prepare(SAMPLE_RATE, BLOCK_SIZE, 1);
+            eq.setCoefficients(bank, false);
+        }
+
+        // numSamples (at most BLOCK_SIZE) more samples, tracking the largest step once measuring
+        void process(int numSamples, bool measure)
+        {
+            buffer.setSize(1, numSamples, false, false, true);
+            for (int i = 0; i < numSamples; ++i)
+                buffer.setSample(0, i, input(position + i));
+            eq.process(buffer);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float y = buffer.getSample(0, i);
+                if (measure)
+                    max_step = juce::jmax(max_step, (double)std::abs(y - previous));
+                previous = y;
+            }
+            position += numSamples;
+        }
+
+        void processSamples(int numSamples, bool measure)
+        {
+            for (int done = 0; done < numSamples; done += BLOCK_SIZE)
+                process(juce::jmin(BLOCK_SIZE, numSamples - done), measure);
+        }
+    };
+
+    double steadyStep(const CoefficientBank& bank)
+    {
+        Run run(bank);
+        run.processSamples(SETTLE_SAMPLES, false);
+        run.processSamples(SWITCH_INTERVAL * NUM_SWITCHES, true);
+        return run.max_step;
+    }
+
+    // Switches every SWITCH_INTERVAL samples, in the middle of whatever block that falls in:
+    // the block is split there, as processBlock splits at MIDI events
+    double switchingStep(const CoefficientBank& a, const CoefficientBank& b, bool smooth)
+    {
+        Run run(a);
+        run.processSamples(SETTLE_SAMPLES, false);
+
+        int untilSwitch = SWITCH_INTERVAL;
+        bool onA = true;
+        for (int s = 0; s < NUM_SWITCHES;)
+        {
+            const int count = juce::jmin(untilSwitch, BLOCK_SIZE - (int)(run.position % BLOCK_SIZE));
+            run.process(count, true);
+            untilSwitch -= count;
+
+            if (untilSwitch == 0)
+            {
+                onA = ! onA;
+                run.eq.setCoefficients(onA ? a : b, smooth);
+                untilSwitch = SWITCH_INTERVAL;
+                ++s;
+            }
+        }
+        return run.max_step;
+    }
+}
+
+void runGlideBenchmark()
+{
+    CoefficientBank a, b;
+    CurveDesigner::design(makeCurve(false), SAMPLE_RATE, a);
+    CurveDesigner::design(makeCurve(true), SAMPLE_RATE, b);
+
+    const double steady = juce::jmax(steadyStep(a), steadyStep(b));
+    const double bound = MAX_STEP_RATIO * steady;
+    const double glide = switchingStep(a, b, true);
+    const double jump = switchingStep(a, b, false);
+    const bool passed = glide <= bound;
+    if (! passed)
+        Results::failed() = true;
+
+    std::cout << "Largest sample-to-sample step, switching between opposite 32-dot curves every "
+              << SWITCH_INTERVAL << " samples:" << std::endl
+              << "  steady state " << juce::String(steady, 5) << ", bound " << juce::String(bound, 5)
+              << ", glide " << juce::String(glide, 5) << (passed ? "" : "  FAILED")
+              << ", jump (for comparison) " << juce::String(jump, 5) << std::endl;
+
+    juce::NamedValueSet values;
+    values.set("steady_step", steady);
+    values.set("bound", bound);
+    values.set("glide_step", glide);
+    values.set("jump_step", jump);
+    values.set("passed", passed);
+    Results::add("opposite curves", values);
+}
@@ -0,0 +1,130 @@
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <thread>
+#include "Benchmarks.h"
+#include "../../../Source/dsp/TripleBuffer.h"
+
+namespace
+{
+    constexpr double SECONDS = 2.0;
+    constexpr int PAYLOAD_WORDS = 128; // 1 KB, so a torn copy has plenty of room to show
+
+    // Every word holds the sequence number it was published with, so a read that mixes
+    // two publishes shows up as words that disagree
+    struct Stamped
+    {
+        juce::uint64 sequence = 0;
+        std::array<juce::uint64, PAYLOAD_WORDS> words{};
+    };
+
+    struct Outcome
+    {
+        juce::uint64 published = 0, received = 0;
+        juce::uint64 torn = 0;          // Reads whose words didn't all match their sequence number
+        juce::uint64 out_of_order = 0;  // update() returning true without a newer sequence number
+        juce::uint64 changed = 0;       // The read buffer changing between update() calls
+        bool got_last = false;          // The final publish arrived
+    };
+
+    bool isIntact(const Stamped& value)
+    {
+        for (const auto word : value.words)
+            if (word != value.sequence)
+                return false;
+        return true;
+    }
+
+    // The writer publishes as fast as it can while the reader updates as fast as it can,
+    // checking everything it reads twice: straight after update(), and again after the
+    // writer has had a chance to touch it. Yielding, each thread gives the other a chance
+    // to run in the middle of its work, which on a machine with few cores is the only way
+    // they interleave at all.
+    Outcome hammer(bool yield)
+    {
+        TripleBuffer<Stamped> buffer;
+        std::atomic<bool> done{ false };
+        Outcome outcome;
+
+        std::thread writer([&]
+        {
+            const auto end = juce::Time::getMillisecondCounterHiRes() + SECONDS * 1000.0;
+            juce::uint64 sequence = 0;
+            while (juce::Time::getMillisecondCounterHiRes() < end)
+            {
+                auto& slot = buffer.getWriteBuffer();
+                slot.sequence = ++sequence;
+                std::fill(slot.words.begin(), slot.words.begin() + PAYLOAD_WORDS / 2, sequence);
+                if (yield && sequence % 16 == 0)
+                    std::this_thread::yield();
+                std::fill(slot.words.begin() + PAYLOAD_WORDS / 2, slot.words.end(), sequence);
+                buffer.publish();
+            }
+
+            outcome.published = sequence;
+            done.store(true, std::memory_order_release);
+        });
+
+        juce::uint64 last = 0;
+        const auto check = [&](bool updated)
+        {
+            const auto& value = buffer.getReadBuffer();
+            if (! isIntact(value))
+                ++outcome.torn;
+            if (updated && value.sequence <= last)
+                ++outcome.out_of_order;
+            if (! updated && value.sequence != last)
+                ++outcome.changed;
+            last = value.sequence;
+        };
+
+        for (;;)
+        {
+            const bool finished = done.load(std::memory_order_acquire);
+
+            const bool updated = buffer.update();
+            check(updated);
+            outcome.received += updated ? 1 : 0;
+
+            if (yield)
+                std::this_thread::yield();
+            check(false);
+
+            if (finished)
+                break;
+        }
+
+        writer.join();
+        outcome.got_last = last == outcome.published;
+        return outcome;
+    }
+
+    void report(const juce::String& name, const Outcome& outcome)
+    {
+        const bool passed = outcome.torn == 0 && outcome.out_of_order == 0 && outcome.changed == 0 && outcome.got_last;
+        if (! passed)
+            Results::failed() = true;
+
+        std::cout << name.paddedRight(' ', 40)
+                  << juce::String((double)outcome.published / SECONDS / 1.0e6, 2).paddedLeft(' ', 8) << " M publishes/s"
+                  << juce::String((double)outcome.received / SECONDS / 1.0e6, 2).paddedLeft(' ', 8) << " M updates/s"
+                  << "  torn " << juce::String(outcome.torn) << ", out of order " << juce::String(outcome.out_of_order)
+                  << ", changed " << juce::String(outcome.changed) << ", last " << (outcome.got_last ? "arrived" : "LOST")
+                  << (passed ? "" : "  FAILED") << std::endl;
+
+        juce::NamedValueSet values;
+        values.set("published", (juce::int64)outcome.published);
+        values.set("received", (juce::int64)outcome.received);
+        values.set("torn", (juce::int64)outcome.torn);
+        values.set("out_of_order", (juce::int64)outcome.out_of_order);
+        values.set("changed", (juce::int64)outcome.changed);
+        values.set("passed", passed);
+        Results::add(name, values);
+    }
+}
+
+void runHandoffBenchmark()
+{
+    report("free running", hammer(false));
+    report("both threads yielding mid-work", hammer(true));
+}
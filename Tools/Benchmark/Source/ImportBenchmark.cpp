@@ -0,0 +1,70 @@
+#include <JuceHeader.h>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include "Benchmarks.h"
+#include "../../../Source/dsp/MeasurementImporter.h"
+
+namespace
+{
+    // A REW-style export: comment header, then frequency, SPL and phase columns, log spaced
+    // from 2 Hz to 24 kHz. Room modes and a treble tilt, plus measurement noise.
+    std::string makeMeasurement(int rows)
+    {
+        std::string text = "* Measurement data measured by REW\n* Freq(Hz) SPL(dB) Phase(degrees)\n";
+        text.reserve((size_t)rows * 28 + text.size());
+
+        std::mt19937 random(1);
+        std::normal_distribution<double> noise(0.0, 0.2);
+        char line[64];
+
+        for (int i = 0; i < rows; ++i)
+        {
+            const double freq = 2.0 * std::pow(12000.0, (double)i / (rows - 1));
+            const double octaves = std::log2(freq / 1000.0);
+            const double spl = 80.0 + 6.0 * std::exp(-std::pow(std::log2(freq / 45.0) * 3.0, 2.0))
+                                    - 4.0 * std::exp(-std::pow(std::log2(freq / 120.0) * 4.0, 2.0))
+                                    - 1.5 * octaves + noise(random);
+            const double phase = std::fmod(freq * 0.37, 360.0) - 180.0;
+
+            const int length = std::snprintf(line, sizeof(line), "%.6f %.3f %.2f\n", freq, spl, phase);
+            text.append(line, (size_t)length);
+        }
+        return text;
+    }
+
+    void benchmarkRows(int rows, int runs)
+    {
+        const auto text = makeMeasurement(rows);
+        juce::TemporaryFile temp(".txt");
+        temp.getFile().replaceWithData(text.data(), text.size());
+
+        MeasurementImporter importer;
+        MeasurementImporter::Options options;
+        std::vector<std::pair<float, float>> dots;
+
+        const auto parseOnly = timeRuns(runs, [&]
+        {
+            importer.importText(text.data(), text.size(), options, dots);
+        });
+        const auto fromFile = timeRuns(runs, [&]
+        {
+            importer.importFile(temp.getFile(), options, dots);
+        });
+
+        const juce::String detail = juce::String(importer.getNumRows()) + " rows -> " + juce::String((int)dots.size())
+                                  + " dots at " + juce::String(importer.getMaxErrorDb(), 2) + " dB, "
+                                  + juce::String(text.size() / 1.0e6, 1) + " MB";
+
+        printTiming(juce::String(rows) + " rows, in memory", parseOnly, detail);
+        printTiming(juce::String(rows) + " rows, from file", fromFile);
+    }
+}
+
+void runImportBenchmark()
+{
+    benchmarkRows(10000, 200);
+    benchmarkRows(100000, 50);
+    benchmarkRows(1000000, 5);
+}
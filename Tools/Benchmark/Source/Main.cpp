@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    Runs the performance benchmarks for the plugin's DSP and editor code.
+
+        Benchmark                       run everything
+        Benchmark import                run just the named benchmarks
+        Benchmark --list                show what there is
+        Benchmark --json results.json   also write every result as JSON, to
+                                        compare between builds
+
+    Build it in Release: Debug timings say nothing about the plugin.
+
+    Some benchmarks also check what they run (glide bounds the output's steps
+    when designs switch mid-block, handoff hammers TripleBuffer from two
+    threads) and make the runner exit with 1 if a check fails.
+    Those are worth running in a ThreadSanitizer build too: add
+    -fsanitize=thread to the exporter's extra compiler and linker flags.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "Benchmarks.h"
+
+namespace
+{
+    struct Benchmark
+    {
+        const char* name;
+        const char* description;
+        void (*run)();
+    };
+
+    const Benchmark benchmarks[] = {
+        { "import",       "Measurement file parsing and curve simplification", runImportBenchmark },
+        { "fit",          "Auto-fit against one section per dot: design time and audio-thread cost", runFitBenchmark },
+        { "cascade",      "BiquadCascade against a juce::dsp::IIR::Filter per section: ns/sample at 8 to 256 sections", runCascadeBenchmark },
+        { "glide",        "Switching between extreme curves mid-block: largest output step against a bound", runGlideBenchmark },
+        { "handoff",      "TripleBuffer hammered from two threads: handoffs per second, no torn or out-of-order reads", runHandoffBenchmark },
+        { "oversampling", "Oversampler against juce::dsp::Oversampling, CPU per channel at each factor", runOversamplingBenchmark },
+        { "process",      "processBlock over sample rates, block sizes and curves: ns/sample and block time percentiles", runProcessBenchmark },
+    };
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // The processor's parameters start a timer, which needs a message manager to belong to
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray names;
+    juce::File jsonFile;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (juce::String (argv[i]) == "--json" && i + 1 < argc)
+            jsonFile = juce::File::getCurrentWorkingDirectory().getChildFile (argv[++i]);
+        else
+            names.add (argv[i]);
+    }
+
+    if (names.contains ("--list"))
+    {
+        for (const auto& benchmark : benchmarks)
+            std::cout << juce::String (benchmark.name).paddedRight (' ', 16) << benchmark.description << std::endl;
+        return 0;
+    }
+
+    for (const auto& name : names)
+        if (std::none_of (std::begin (benchmarks), std::end (benchmarks), [&] (const Benchmark& b) { return name == b.name; }))
+        {
+            std::cerr << "Unknown benchmark: " << name << " (see --list)" << std::endl;
+            return 1;
+        }
+
+   #if JUCE_DEBUG
+    std::cout << "Warning: this is a Debug build" << std::endl;
+   #endif
+
+    for (const auto& benchmark : benchmarks)
+    {
+        if (! names.isEmpty() && ! names.contains (benchmark.name))
+            continue;
+
+        std::cout << "== " << benchmark.name << " ==" << std::endl;
+        Results::currentBenchmark() = benchmark.name;
+        benchmark.run();
+        std::cout << std::endl;
+    }
+
+    if (jsonFile != juce::File())
+    {
+        auto* root = new juce::DynamicObject();
+        root->setProperty ("cpu", juce::SystemStats::getCpuModel());
+        root->setProperty ("os", juce::SystemStats::getOperatingSystemName());
+        root->setProperty ("juce", juce::SystemStats::getJUCEVersion());
+       #if JUCE_DEBUG
+        root->setProperty ("build", "Debug");
+       #else
+        root->setProperty ("build", "Release");
+       #endif
+        root->setProperty ("date", juce::Time::getCurrentTime().toISO8601 (true));
+        root->setProperty ("results", Results::get());
+
+        if (! jsonFile.replaceWithText (juce::JSON::toString (juce::var (root))))
+        {
+            std::cerr << "Couldn't write " << jsonFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    return Results::failed() ? 1 : 0;
+}
@@ -0,0 +1,75 @@
+#include <JuceHeader.h>
+#include <random>
+#include "Benchmarks.h"
+#include "../../../Source/dsp/Oversampler.h"
+
+namespace
+{
+    constexpr double SAMPLE_RATE = 48000.0;
+    constexpr int BLOCK_SIZE = 512;
+    constexpr int NUM_CHANNELS = 2;
+    constexpr int RUNS = 2000;
+
+    juce::AudioBuffer<float> makeNoise()
+    {
+        juce::AudioBuffer<float> buffer(NUM_CHANNELS, BLOCK_SIZE);
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+        for (int c = 0; c < NUM_CHANNELS; ++c)
+            for (int i = 0; i < BLOCK_SIZE; ++i)
+                buffer.setSample(c, i, noise(random));
+        return buffer;
+    }
+
+    // Per channel, and as a share of the time the block lasts
+    juce::String describe(const Timing& timing, int latency)
+    {
+        const double blockMs = BLOCK_SIZE / SAMPLE_RATE * 1000.0;
+        const double channelMs = timing.median_ms / NUM_CHANNELS;
+        return juce::String(channelMs * 1000.0, 2) + " us/channel (" + juce::String(100.0 * channelMs / blockMs, 3)
+             + "% of real time), latency " + juce::String(latency);
+    }
+
+    // Up and straight back down: only the filters' cost, none of the EQ's
+    void benchmarkFactor(int factor)
+    {
+        auto buffer = makeNoise();
+        const auto prefix = juce::String(factor) + "x, ";
+
+        Oversampler oversampler;
+        oversampler.prepare(NUM_CHANNELS, BLOCK_SIZE, factor);
+        const auto ours = timeRuns(RUNS, [&]
+        {
+            oversampler.processUp(buffer);
+            oversampler.processDown(buffer);
+        });
+        printTiming(prefix + "Oversampler", ours, describe(ours, oversampler.getLatencySamples()));
+
+        const int stages = factor == 8 ? 3 : factor == 4 ? 2 : 1;
+        const std::pair<const char*, juce::dsp::Oversampling<float>::FilterType> juceFilters[] = {
+            { "juce::dsp::Oversampling IIR", juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR },
+            { "juce::dsp::Oversampling FIR", juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple },
+        };
+
+        for (const auto& [name, type] : juceFilters)
+        {
+            juce::dsp::Oversampling<float> juceOversampler((size_t)NUM_CHANNELS, (size_t)stages, type, true, true);
+            juceOversampler.initProcessing((size_t)BLOCK_SIZE);
+
+            juce::dsp::AudioBlock<float> block(buffer);
+            const auto theirs = timeRuns(RUNS, [&]
+            {
+                juceOversampler.processSamplesUp(block);
+                juceOversampler.processSamplesDown(block);
+            });
+            printTiming(prefix + name, theirs, describe(theirs, (int)juceOversampler.getLatencyInSamples())
+                                               + ", " + juce::String(theirs.median_ms / ours.median_ms, 1) + "x ours");
+        }
+    }
+}
+
+void runOversamplingBenchmark()
+{
+    for (int factor = 2; factor <= Oversampler::MAX_FACTOR; factor *= 2)
+        benchmarkFactor(factor);
+}
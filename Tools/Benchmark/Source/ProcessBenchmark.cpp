@@ -0,0 +1,213 @@
+#include <JuceHeader.h>
+#include <cmath>
+#include <random>
+#include "Benchmarks.h"
+#include "../../../Source/PluginProcessor.h"
+
+namespace
+{
+    constexpr double SECONDS_PER_CASE = 2.0;
+    constexpr double DESIGN_TIMEOUT_MS = 30000.0;
+    // Of audio, once the setup's designs have landed: long enough to finish the glide to them
+    // and to warm the caches
+    constexpr double WARM_UP_SECONDS = 0.25;
+    static_assert(WARM_UP_SECONDS > 2.0 * EqEngine::RAMP_SECONDS, "The warm-up must cover the glide");
+    constexpr int MIN_BLOCKS = 500;
+    constexpr double SLOT_SWITCH_SECONDS = 0.1;
+
+    const double SAMPLE_RATES[] = { 44100.0, 48000.0, 96000.0, 192000.0 };
+    const int BLOCK_SIZES[] = { 16, 64, 256, 1024, 4096 };
+    const int DOT_COUNTS[] = { 2, 16, 64, 256 };
+    const int CHANNEL_COUNTS[] = { 1, 2, 6, 12, 16, 24 }; // Up to 7.1.4 and past
+
+    struct Mode
+    {
+        const char* name;
+        bool linear_phase;
+        bool auto_fit;
+        int oversampling;
+        bool dynamic; // Every dot, with a threshold the test noise goes over
+        bool morph;   // CC 1 sweeping between the curve and another at 1 kHz, an event a millisecond
+        bool slots;   // Switching between two curve slots every SLOT_SWITCH_SECONDS
+    };
+
+    // A tilt with ripple on top, and some seeded randomness so consecutive dots aren't alike
+    CurveSnapshot makeCurve(int numDots, bool dynamic)
+    {
+        std::mt19937 random((unsigned int)numDots);
+        std::uniform_real_distribution<float> detail(-3.0f, 3.0f);
+
+        std::vector<std::pair<float, float>> dots;
+        for (int i = 0; i < numDots; ++i)
+        {
+            const float t = (float)i / (float)(numDots - 1);
+            const float freq = 20.0f * std::pow(1000.0f, t);
+            dots.emplace_back(freq, 6.0f * std::sin(t * 9.0f) - 4.0f * t + (numDots > 2 ? detail(random) : 0.0f));
+        }
+
+        DotDynamics dynamics;
+        dynamics.enabled = dynamic;
+        dynamics.threshold_db = -40.0f;
+        return CurveSnapshot::fromDots(dots, std::vector<DotDynamics>(dots.size(), dynamics));
+    }
+
+    // setCurve(), setAutoFit() and the rest each queue a design, and prepareToPlay() another.
+    // Timing while one is still on the design thread would catch it landing and starting a
+    // glide partway through, so wait for the newest to be done. (Each slot switch queues one
+    // too, as it would in a host; those are part of what that mode measures.)
+    void waitForDesigns(const Juce_sandboxAudioProcessor& processor)
+    {
+        const auto deadline = juce::Time::getMillisecondCounterHiRes() + DESIGN_TIMEOUT_MS;
+        while (! processor.getDesignMetrics().idle)
+        {
+            if (juce::Time::getMillisecondCounterHiRes() > deadline)
+            {
+                std::cout << "Warning: designs still pending after " << DESIGN_TIMEOUT_MS / 1000.0 << " s" << std::endl;
+                return;
+            }
+
+            juce::Thread::sleep(1);
+        }
+    }
+
+    double percentile(const std::vector<double>& sorted, double p)
+    {
+        return sorted[(size_t)juce::roundToInt(p * (double)(sorted.size() - 1))];
+    }
+
+    void benchmarkCase(const Mode& mode, double sampleRate, int blockSize, int numDots, int numChannels = 2)
+    {
+        Juce_sandboxAudioProcessor processor;
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add(juce::AudioChannelSet::discreteChannels(numChannels));
+        layout.outputBuses.add(juce::AudioChannelSet::discreteChannels(numChannels));
+        processor.setBusesLayout(layout);
+        processor.setLinearPhase(mode.linear_phase);
+        processor.setAutoFit(mode.auto_fit);
+        processor.setOversampling(mode.oversampling);
+        processor.setCurve(makeCurve(numDots, mode.dynamic));
+        if (mode.morph)
+        {
+            MorphSettings morph;
+            morph.source = MorphSettings::Source::Controller;
+            processor.setMorphTarget(makeCurve(numDots + 1, false));
+            processor.setMorphSettings(morph);
+        }
+        if (mode.slots)
+        {
+            processor.setCurrentProgram(1);
+            processor.setCurve(makeCurve(numDots + 1, mode.dynamic));
+            processor.setCurrentProgram(0);
+        }
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        juce::AudioBuffer<float> source(numChannels, blockSize), buffer(numChannels, blockSize);
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> noise(-0.25f, 0.25f);
+        juce::MidiBuffer midi;
+        const int eventInterval = juce::roundToInt(sampleRate / 1000.0);
+        int eventPhase = 0, controllerValue = 0;
+        const int switchInterval = juce::jmax(1, juce::roundToInt(SLOT_SWITCH_SECONDS * sampleRate / blockSize));
+        int blockIndex = 0;
+
+        const auto processOne = [&]
+        {
+            for (int c = 0; c < numChannels; ++c)
+                for (int i = 0; i < blockSize; ++i)
+                    source.setSample(c, i, noise(random));
+            buffer.makeCopyOf(source, true);
+
+            // A triangle sweep over the whole controller range, made before the timing starts
+            midi.clear();
+            if (mode.morph)
+            {
+                for (; eventPhase < blockSize; eventPhase += eventInterval, ++controllerValue)
+                    midi.addEvent(juce::MidiMessage::controllerEvent(1, 1, std::abs(controllerValue % 254 - 127)), eventPhase);
+                eventPhase -= blockSize;
+            }
+
+            // The program change lands on the processor's next block, like a host's would
+            if (mode.slots && ++blockIndex % switchInterval == 0)
+                processor.setCurrentProgram(1 - processor.getCurrentProgram());
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            processor.processBlock(buffer, midi);
+            return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1.0e9;
+        };
+
+        waitForDesigns(processor);
+        for (int b = 0; b < juce::roundToInt(std::ceil(WARM_UP_SECONDS * sampleRate / blockSize)); ++b)
+            processOne();
+
+        const int numBlocks = juce::jmax(MIN_BLOCKS, juce::roundToInt(SECONDS_PER_CASE * sampleRate / blockSize));
+        std::vector<double> blockNs((size_t)numBlocks);
+        double totalNs = 0.0;
+        for (auto& ns : blockNs)
+            totalNs += (ns = processOne());
+
+        processor.releaseResources();
+
+        std::sort(blockNs.begin(), blockNs.end());
+        const double nsPerSample = totalNs / ((double)numBlocks * blockSize);
+        const double blockBudgetNs = blockSize / sampleRate * 1.0e9;
+        const double worstNs = blockNs.back();
+
+        const auto name = juce::String(mode.name) + ", " + juce::String(sampleRate / 1000.0, 1) + " kHz, "
+                        + juce::String(blockSize) + " samples, " + juce::String(numDots) + " dots"
+                        + (numChannels != 2 ? ", " + juce::String(numChannels) + " channels" : juce::String());
+
+        std::cout << name.paddedRight(' ', 60)
+                  << juce::String(nsPerSample, 2).paddedLeft(' ', 8) << " ns/sample"
+                  << "  block us p50 " << juce::String(percentile(blockNs, 0.5) / 1000.0, 2).paddedLeft(' ', 8)
+                  << "  p99 " << juce::String(percentile(blockNs, 0.99) / 1000.0, 2).paddedLeft(' ', 8)
+                  << "  p99.9 " << juce::String(percentile(blockNs, 0.999) / 1000.0, 2).paddedLeft(' ', 8)
+                  << "  worst " << juce::String(worstNs / 1000.0, 2).paddedLeft(' ', 8)
+                  << " (" << juce::String(100.0 * worstNs / blockBudgetNs, 1) << "% of the block)" << std::endl;
+
+        juce::NamedValueSet values;
+        values.set("mode", mode.name);
+        values.set("sample_rate", sampleRate);
+        values.set("block_size", blockSize);
+        values.set("dots", numDots);
+        values.set("channels", numChannels);
+        values.set("blocks", numBlocks);
+        values.set("ns_per_sample", nsPerSample);
+        values.set("block_us_p50", percentile(blockNs, 0.5) / 1000.0);
+        values.set("block_us_p90", percentile(blockNs, 0.9) / 1000.0);
+        values.set("block_us_p99", percentile(blockNs, 0.99) / 1000.0);
+        values.set("block_us_p999", percentile(blockNs, 0.999) / 1000.0);
+        values.set("block_us_worst", worstNs / 1000.0);
+        values.set("worst_block_budget", worstNs / blockBudgetNs); // Fraction of the block's duration
+        Results::add(name, values);
+    }
+}
+
+void runProcessBenchmark()
+{
+    // The default mode over the whole matrix
+    const Mode cascade{ "cascade", false, false, 1, false, false, false };
+    for (const auto sampleRate : SAMPLE_RATES)
+        for (const auto blockSize : BLOCK_SIZES)
+            for (const auto numDots : DOT_COUNTS)
+                benchmarkCase(cascade, sampleRate, blockSize, numDots);
+
+    // The other modes at one rate. Linear phase times the audio thread's share only: the FIR
+    // tail runs on its worker thread.
+    const Mode modes[] = {
+        { "auto-fit", false, true, 1, false, false, false },
+        { "4x oversampling", false, false, 4, false, false, false },
+        { "linear phase", true, false, 1, false, false, false },
+        { "dynamic", false, false, 1, true, false, false },
+        { "CC morph", false, false, 1, false, true, false },
+        { "slot switching", false, false, 1, false, false, true },
+    };
+    for (const auto& mode : modes)
+        for (const auto blockSize : BLOCK_SIZES)
+            benchmarkCase(mode, 48000.0, blockSize, 64);
+
+    // Bus widths. The cascade runs wide buses with channels across vector lanes, so
+    // ns/sample should grow slower than the channel count.
+    for (const auto numChannels : CHANNEL_COUNTS)
+        benchmarkCase(cascade, 48000.0, 256, 64, numChannels);
+}
@@ -0,0 +1,241 @@
+/*
+  ==============================================================================
+
+    Renders audio files through the plugin's EQ, without a host.
+
+        Renderer --preset curve.xml --out dir [--threads n] [--block n] inputs...
+
+    Inputs are files or folders (searched recursively for WAV, FLAC and AIFF).
+    Each file gets its own Juce_sandboxAudioProcessor and goes through it the way a
+    DAW bounces offline: setNonRealtime (true), prepareToPlay, then processBlock in
+    blocks of --block samples (65536 by default). Files run in parallel on a thread
+    pool, one thread per core unless --threads says otherwise.
+
+    Outputs keep the input's format, sample rate, channel count and bit depth
+    (formats that can't be written become WAV), and folder inputs keep their
+    layout under --out. The processor's latency is compensated: every output lines
+    up with its input sample for sample and is exactly as long.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+namespace
+{
+    constexpr int DEFAULT_BLOCK_SIZE = 65536;
+    const char* const AUDIO_FILES = "*.wav;*.flac;*.aif;*.aiff";
+
+    struct Render
+    {
+        juce::File input, output;
+        juce::Result result = juce::Result::ok();
+        double audio_seconds = 0.0;
+        double wall_seconds = 0.0;
+    };
+
+    juce::Result render (const juce::File& input, const juce::File& output, const CurvePreset& preset, int blockSize, double& audioSeconds)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        if (output == input)
+            return juce::Result::fail (input.getFullPathName() + " would be overwritten by its own output");
+
+        std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (input));
+        if (reader == nullptr)
+            return juce::Result::fail ("Couldn't read " + input.getFullPathName());
+
+        const int numChannels = (int) reader->numChannels;
+        const double sampleRate = reader->sampleRate;
+        const auto length = reader->lengthInSamples;
+
+        // Same bus layout for input and output, as a host would ask for
+        Juce_sandboxAudioProcessor processor;
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add (juce::AudioChannelSet::canonicalChannelSet (numChannels));
+        layout.outputBuses.add (juce::AudioChannelSet::canonicalChannelSet (numChannels));
+        if (! processor.setBusesLayout (layout))
+            return juce::Result::fail (input.getFileName() + ": " + juce::String (numChannels) + " channels aren't supported");
+
+        // Settings before the sample rate, so changing the oversampling doesn't re-prepare
+        processor.setPreset (preset);
+        processor.setNonRealtime (true);
+        processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        processor.prepareToPlay (sampleRate, blockSize);
+
+        auto* format = formats.findFormatForFileExtension (output.getFileExtension());
+        jassert (format != nullptr);
+
+        const int bitsPerSample = format->getPossibleBitDepths().contains ((int) reader->bitsPerSample) ? (int) reader->bitsPerSample : 24;
+
+        if (! output.getParentDirectory().createDirectory() || (output.exists() && ! output.deleteFile()))
+            return juce::Result::fail ("Couldn't write " + output.getFullPathName());
+
+        auto stream = output.createOutputStream();
+        if (stream == nullptr)
+            return juce::Result::fail ("Couldn't write " + output.getFullPathName());
+
+        std::unique_ptr<juce::AudioFormatWriter> writer (format->createWriterFor (stream.get(), sampleRate, (unsigned int) numChannels,
+                                                                                  bitsPerSample, reader->metadataValues, 0));
+        if (writer == nullptr)
+            return juce::Result::fail ("Can't write " + juce::String (numChannels) + " channels at " + juce::String (sampleRate)
+                                       + " Hz, " + juce::String (bitsPerSample) + " bits to " + output.getFullPathName());
+        stream.release(); // The writer owns it now
+
+        // Run on past the end by the latency, which the reader fills with silence, and drop
+        // that many samples from the start instead
+        const int latency = processor.getLatencySamples();
+        juce::AudioBuffer<float> buffer (numChannels, blockSize);
+        juce::MidiBuffer midi;
+
+        for (juce::int64 position = 0; position < length + latency; position += blockSize)
+        {
+            const int numSamples = (int) juce::jmin ((juce::int64) blockSize, length + latency - position);
+            buffer.setSize (numChannels, numSamples, false, false, true);
+            reader->read (&buffer, 0, numSamples, position, true, true);
+
+            processor.processBlock (buffer, midi);
+
+            const int skip = (int) juce::jlimit ((juce::int64) 0, (juce::int64) numSamples, latency - position);
+            if (! writer->writeFromAudioSampleBuffer (buffer, skip, numSamples - skip))
+                return juce::Result::fail ("Couldn't write " + output.getFullPathName());
+        }
+
+        processor.releaseResources();
+        audioSeconds = (double) length / sampleRate;
+        return juce::Result::ok();
+    }
+
+    // Where the output for input goes: its path under the folder it was found in, if any, moved to outputDir
+    juce::File getOutputFile (const juce::File& input, const juce::File& searchedFolder, const juce::File& outputDir, juce::AudioFormatManager& formats)
+    {
+        auto relative = searchedFolder == juce::File() ? input.getFileName() : input.getRelativePathFrom (searchedFolder);
+        auto output = outputDir.getChildFile (relative);
+
+        auto* format = formats.findFormatForFileExtension (input.getFileExtension());
+        if (format == nullptr || format->getPossibleBitDepths().isEmpty())
+            output = output.withFileExtension ("wav");
+
+        return output;
+    }
+
+    void printUsage()
+    {
+        std::cout << "Usage: Renderer --preset curve.xml --out dir [--threads n] [--block n] inputs..." << std::endl
+                  << "Inputs are audio files or folders of them (" << AUDIO_FILES << ")." << std::endl;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // The processor's parameters start a timer, which needs a message manager to belong to
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::File presetFile, outputDir;
+    int numThreads = juce::SystemStats::getNumCpus();
+    int blockSize = DEFAULT_BLOCK_SIZE;
+    juce::StringArray inputs;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg (argv[i]);
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--preset" && hasValue)       presetFile = juce::File::getCurrentWorkingDirectory().getChildFile (argv[++i]);
+        else if (arg == "--out" && hasValue)     outputDir = juce::File::getCurrentWorkingDirectory().getChildFile (argv[++i]);
+        else if (arg == "--threads" && hasValue) numThreads = juce::jmax (1, juce::String (argv[++i]).getIntValue());
+        else if (arg == "--block" && hasValue)   blockSize = juce::jlimit (64, 1 << 20, juce::String (argv[++i]).getIntValue());
+        else if (arg.startsWith ("--"))          { printUsage(); return 1; }
+        else                                     inputs.add (arg);
+    }
+
+    if (presetFile == juce::File() || outputDir == juce::File() || inputs.isEmpty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    CurvePreset preset;
+    const auto loaded = preset.loadFrom (presetFile);
+    if (loaded.failed())
+    {
+        std::cerr << loaded.getErrorMessage() << std::endl;
+        return 1;
+    }
+
+    // Expand folders, remembering where each file was found so outputs keep the layout
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    std::vector<Render> renders;
+    for (const auto& path : inputs)
+    {
+        const auto input = juce::File::getCurrentWorkingDirectory().getChildFile (path);
+
+        if (input.isDirectory())
+        {
+            for (const auto& file : input.findChildFiles (juce::File::findFiles, true, AUDIO_FILES))
+                renders.push_back ({ file, getOutputFile (file, input, outputDir, formats) });
+        }
+        else if (input.existsAsFile())
+        {
+            renders.push_back ({ input, getOutputFile (input, {}, outputDir, formats) });
+        }
+        else
+        {
+            std::cerr << path << " doesn't exist" << std::endl;
+            return 1;
+        }
+    }
+
+   #if JUCE_DEBUG
+    std::cout << "Warning: this is a Debug build" << std::endl;
+   #endif
+
+    // One job per file, each with its own processor
+    juce::CriticalSection printLock;
+    juce::ThreadPool pool (juce::jmin (numThreads, juce::jmax (1, (int) renders.size())));
+    const auto start = juce::Time::getHighResolutionTicks();
+
+    for (auto& job : renders)
+    {
+        pool.addJob ([&job, &preset, &printLock, blockSize]
+        {
+            const auto jobStart = juce::Time::getHighResolutionTicks();
+            job.result = render (job.input, job.output, preset, blockSize, job.audio_seconds);
+            job.wall_seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - jobStart);
+
+            const juce::ScopedLock lock (printLock);
+            if (job.result.failed())
+                std::cerr << job.result.getErrorMessage() << std::endl;
+            else
+                std::cout << job.output.getFullPathName() << ": " << juce::String (job.audio_seconds, 1) << " s in "
+                          << juce::String (job.wall_seconds, 2) << " s, "
+                          << juce::String (job.audio_seconds / juce::jmax (1.0e-9, job.wall_seconds), 1) << "x real time" << std::endl;
+        });
+    }
+
+    while (pool.getNumJobs() > 0)
+        juce::Thread::sleep (20);
+
+    const auto wallSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+
+    // Throughput of the whole batch: total audio over wall time, so it counts the parallelism
+    int numFailed = 0;
+    double audioSeconds = 0.0;
+    for (const auto& job : renders)
+    {
+        numFailed += job.result.failed() ? 1 : 0;
+        audioSeconds += job.audio_seconds;
+    }
+
+    std::cout << std::endl << (int) renders.size() - numFailed << " of " << (int) renders.size() << " files, "
+              << juce::String (audioSeconds, 1) << " s of audio in " << juce::String (wallSeconds, 2) << " s on "
+              << pool.getNumThreads() << " threads: " << juce::String (audioSeconds / juce::jmax (1.0e-9, wallSeconds), 1)
+              << "x real time" << std::endl;
+
+    return numFailed == 0 ? 0 : 1;
+}